@@ -4,6 +4,8 @@
 
 #include <wayland-server-core.h>
 
+struct buf;
+
 struct path {
 	char *string;
 	struct wl_list link;
@@ -17,4 +19,11 @@ void paths_theme_create(struct wl_list *paths, const char *theme_name,
 	const char *filename);
 void paths_destroy(struct wl_list *paths);
 
+/*
+ * Append the size and modification time of each path to snapshot, and of
+ * the entries of those that are directories (non-recursively). Comparing
+ * two snapshots tells whether any of the files have changed in between.
+ */
+void paths_stat_snapshot(struct wl_list *paths, struct buf *snapshot);
+
 #endif /* LABWC_DIR_H */
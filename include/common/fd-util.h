@@ -3,6 +3,11 @@
 #define LABWC_FD_UTIL_H
 
 void increase_nofile_limit(void);
+
+/*
+ * Restore the limit for a child process. Does not log so that it can be
+ * used between vfork() and exec().
+ */
 void restore_nofile_limit(void);
 
 #endif /* LABWC_FD_UTIL_H */
@@ -0,0 +1,44 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+#ifndef LABWC_GLYPH_ATLAS_H
+#define LABWC_GLYPH_ATLAS_H
+
+struct font;
+struct glyph_atlas;
+struct lab_data_buffer;
+
+/**
+ * glyph_atlas_create - pre-layout a small set of single-byte glyphs
+ * @glyphs: ASCII characters which can later be rendered, e.g. "0123456789"
+ * @font: font description
+ * @color: foreground color in rgba format
+ * @bg_color: background color in rgba format
+ *
+ * The glyphs are laid out with pango once and rendered once per scale on
+ * first use. Strings made up of these glyphs can then be rendered by just
+ * copying pixels around, which is a lot cheaper than a full pango layout.
+ * This is meant for short, frequently changing labels like the resize
+ * indicator. Kerning between glyphs is not applied.
+ */
+struct glyph_atlas *glyph_atlas_create(const char *glyphs, struct font *font,
+	const float *color, const float *bg_color);
+
+void glyph_atlas_destroy(struct glyph_atlas *atlas);
+
+/* Height of the rendered text in layout pixels */
+int glyph_atlas_height(struct glyph_atlas *atlas);
+
+/* Width of @text in layout pixels. Unknown characters are skipped. */
+int glyph_atlas_text_width(struct glyph_atlas *atlas, const char *text);
+
+/**
+ * glyph_atlas_render - Create ARGB8888 lab_data_buffer for @text
+ * @atlas: glyph atlas
+ * @text: text consisting of glyphs given to glyph_atlas_create()
+ * @scale: output scale to render for
+ *
+ * Returns NULL if @text is empty.
+ */
+struct lab_data_buffer *glyph_atlas_render(struct glyph_atlas *atlas,
+	const char *text, double scale);
+
+#endif /* LABWC_GLYPH_ATLAS_H */
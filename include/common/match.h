@@ -3,6 +3,7 @@
 #define LABWC_MATCH_H
 
 #include <stdbool.h>
+#include <stddef.h>
 
 /**
  * match_glob() - Pattern match using '*' wildcards and '?' jokers.
@@ -12,4 +13,36 @@
  */
 bool match_glob(const char *pattern, const char *string);
 
+enum glob_matcher_type {
+	LAB_GLOB_NONE = 0,	/* no pattern, matches everything */
+	LAB_GLOB_ANY,		/* "*", matches any string */
+	LAB_GLOB_LITERAL,	/* no wildcards */
+	LAB_GLOB_PREFIX,	/* literal followed by a single trailing '*' */
+	LAB_GLOB_FNMATCH,	/* anything else */
+};
+
+/*
+ * A pattern pre-analyzed by glob_matcher_init() so that the common cases
+ * can be matched with a plain (case-insensitive) string comparison rather
+ * than fnmatch(). The matcher does not own @pattern.
+ */
+struct glob_matcher {
+	enum glob_matcher_type type;
+	const char *pattern;
+	size_t len;
+};
+
+/**
+ * glob_matcher_init() - Prepare @pattern for use with glob_matcher_match()
+ * @pattern: Pattern as accepted by match_glob() or NULL
+ */
+void glob_matcher_init(struct glob_matcher *matcher, const char *pattern);
+
+/**
+ * glob_matcher_match() - Same as match_glob() with the pattern given to
+ * glob_matcher_init(). A NULL pattern matches anything (including NULL),
+ * otherwise a NULL @string never matches.
+ */
+bool glob_matcher_match(const struct glob_matcher *matcher, const char *string);
+
 #endif /* LABWC_MATCH_H */
@@ -58,4 +58,12 @@ void scaled_font_buffer_update(struct scaled_font_buffer *self, const char *text
  */
 void scaled_font_buffer_set_max_width(struct scaled_font_buffer *self, int max_width);
 
+/**
+ * Render the current text for @scale ahead of time so that showing the
+ * buffer on an output with that scale does not need to render it.
+ *
+ * See scaled_scene_buffer_prerender() for details.
+ */
+void scaled_font_buffer_prerender(struct scaled_font_buffer *self, double scale);
+
 #endif /* LABWC_SCALED_FONT_BUFFER_H */
@@ -84,6 +84,15 @@ struct scaled_scene_buffer *scaled_scene_buffer_create(
 /* Clear the cache of existing buffers, useful in case the content changes */
 void scaled_scene_buffer_invalidate_cache(struct scaled_scene_buffer *self);
 
+/**
+ * Render a buffer for @scale and add it to the cache without displaying it,
+ * so that a later move to an output with that scale is served from the
+ * cache. Does nothing if a buffer for @scale is already cached or if there
+ * is no free cache slot (the buffer currently shown is never evicted).
+ */
+void scaled_scene_buffer_prerender(struct scaled_scene_buffer *self,
+	double scale);
+
 /* Private */
 struct scaled_scene_buffer_cache_entry {
 	struct wl_list link;   /* struct scaled_scene_buffer.cache */
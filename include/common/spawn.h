@@ -38,4 +38,12 @@ pid_t spawn_piped(const char *command, int *pipe_fd);
  */
 void spawn_piped_close(pid_t pid, int pipe_fd);
 
+/**
+ * spawn_reap_child - reap one exited child started by the functions above
+ *
+ * Returns the pid of the reaped child or 0 if none has exited. Should be
+ * called repeatedly on SIGCHLD until it returns 0.
+ */
+pid_t spawn_reap_child(void);
+
 #endif /* LABWC_SPAWN_H */
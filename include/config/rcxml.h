@@ -71,6 +71,7 @@ struct rcxml {
 	bool reuse_output_mode;
 	enum view_placement_policy placement_policy;
 	bool xwayland_persistence;
+	int xwayland_prewarm_delay;
 	int placement_cascade_offset_x;
 	int placement_cascade_offset_y;
 
@@ -82,6 +83,7 @@ struct rcxml {
 	/* theme */
 	char *theme_name;
 	char *icon_theme_name;
+	int icon_cache_size; /* KiB */
 	struct wl_list title_buttons_left;
 	struct wl_list title_buttons_right;
 	int corner_radius;
@@ -185,6 +187,13 @@ extern struct rcxml rc;
 
 void rcxml_parse_xml(struct buf *b);
 void rcxml_read(const char *filename);
+
+/*
+ * Returns true if the config files read by rcxml_read() have been
+ * added, removed or modified since they were last parsed
+ */
+bool rcxml_config_changed(const char *filename);
+
 void rcxml_finish(void);
 
 #endif /* LABWC_RCXML_H */
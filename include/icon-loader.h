@@ -2,11 +2,55 @@
 #ifndef LABWC_ICON_LOADER_H
 #define LABWC_ICON_LOADER_H
 
+#include <stdbool.h>
+#include <stddef.h>
+
+struct icon_request;
+struct lab_data_buffer;
 struct server;
 
 void icon_loader_init(struct server *server);
+
+/*
+ * Completes all outstanding requests; those that have not been processed
+ * yet get a NULL buffer.
+ */
 void icon_loader_finish(struct server *server);
-struct lab_data_buffer *icon_loader_lookup(struct server *server,
-	const char *app_id, int size, float scale);
+
+/*
+ * Makes the icon loader pick up changes to desktop entries and icon themes
+ * on Reconfigure. Returns true if it had to be recreated because the icon
+ * theme changed, in which case icons already shown need to be reloaded.
+ */
+bool icon_loader_reload(struct server *server);
+
+/*
+ * Looks up and loads the icon for app_id on a worker thread. Once done,
+ * callback is called on the compositor thread with the icon, or with NULL
+ * if none was found. The buffer is dropped after the callback returns, so
+ * it needs to be locked to be kept around.
+ *
+ * Icons are cached per app_id, size and scale. On a cache hit callback
+ * is called immediately. NULL is returned in that case, and also (without
+ * calling callback) if the icon loader is not available. Otherwise the
+ * request must not be used after callback was called.
+ */
+struct icon_request *icon_loader_request(struct server *server,
+	const char *app_id, int size, float scale,
+	void (*callback)(struct lab_data_buffer *buffer, void *data),
+	void *data);
+
+/* Prevents callback from being called for a pending request */
+void icon_request_cancel(struct server *server, struct icon_request *request);
+
+struct icon_cache_stats {
+	int entries;
+	size_t bytes;
+	unsigned int hits;
+	unsigned int misses;
+};
+
+void icon_loader_get_cache_stats(struct server *server,
+	struct icon_cache_stats *stats);
 
 #endif /* LABWC_ICON_LOADER_H */
@@ -8,4 +8,7 @@ struct wlr_seat;
 void idle_manager_create(struct wl_display *display, struct wlr_seat *wlr_seat);
 void idle_manager_notify_activity(struct wlr_seat *seat);
 
+/* Returns the time since the last user input, or since startup */
+int idle_manager_get_idle_msec(void);
+
 #endif /* LABWC_IDLE_H */
@@ -120,6 +120,14 @@ struct seat {
 	/* In support for ToggleKeybinds */
 	uint32_t nr_inhibited_keybind_views;
 
+	/* Used to coalesce cursor motion during interactive move/resize */
+	struct {
+		struct wl_event_source *timer;
+		bool throttled;
+		bool pending;
+		uint32_t time;
+	} grab_motion;
+
 	/* Used to hide the workspace OSD after switching workspaces */
 	struct wl_event_source *workspace_osd_timer;
 	bool workspace_osd_shown_by_modifier;
@@ -198,6 +206,11 @@ struct seat {
 	struct wl_list tablets;
 	struct wl_list tablet_tools;
 	struct wl_list tablet_pads;
+	/*
+	 * Changed by the *TabletMouseEmulation actions, reset to
+	 * rc.tablet.force_mouse_emulation on Reconfigure
+	 */
+	bool force_tablet_mouse_emulation;
 
 	struct wl_listener constraint_commit;
 	struct wl_listener pressed_surface_destroy;
@@ -243,6 +256,8 @@ struct server {
 	struct wl_listener xwayland_server_ready;
 	struct wl_listener xwayland_xwm_ready;
 	struct wl_listener xwayland_new_surface;
+	/* xwayland_view.stack_link, top-most first as last sent to the XWM */
+	struct wl_list xwayland_stack;
 #endif
 
 	struct wlr_xdg_activation_v1 *xdg_activation;
@@ -250,6 +265,13 @@ struct server {
 	struct wl_listener xdg_activation_new_token;
 
 	struct wl_list views;
+	/* struct view.workspace_link, in the same order as server->views */
+	struct wl_list views_always_on_top;
+	/* Last stacking serials handed out, see view_stack_move() */
+	struct {
+		int64_t front;
+		int64_t back;
+	} view_stack_serials;
 	struct wl_list unmanaged_surfaces;
 
 	struct seat seat;
@@ -330,6 +352,13 @@ struct server {
 	 * do_output_layout_change() must be called explicitly.
 	 */
 	int pending_output_layout_change;
+	/*
+	 * Armed after an output layout change while views are still
+	 * resizing to their new geometry. Until they have all committed
+	 * (or the timer expires), outputs keep showing the previous frame
+	 * so that the re-arrangement appears at once.
+	 */
+	struct wl_event_source *layout_change_timeout;
 
 	struct wl_listener renderer_lost;
 
@@ -85,6 +85,13 @@ bool menu_call_selected_actions(struct server *server);
 
 void menu_init(struct server *server);
 void menu_finish(struct server *server);
+
+/**
+ * menu_prerender - render the static menus for all output scales in use
+ * in the background, so that opening them later does not have to.
+ * Called whenever the set of outputs or their scales may have changed.
+ */
+void menu_prerender(struct server *server);
 void menu_on_view_destroy(struct view *view);
 
 /**
@@ -134,6 +141,9 @@ bool menu_call_actions(struct wlr_scene_node *node);
  */
 void menu_close_root(struct server *server);
 
+/* menu_files_changed - check if menu.xml was modified since it was read */
+bool menu_files_changed(void);
+
 /* menu_reconfigure - reload theme and content */
 void menu_reconfigure(struct server *server);
 
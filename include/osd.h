@@ -29,6 +29,7 @@ struct window_switcher_field {
 	enum window_switcher_field_content content;
 	int width;
 	char *format;
+	struct wl_array format_ops; /* compiled format, see osd-field.c */
 	struct wl_list link; /* struct rcxml.window_switcher.fields */
 };
 
@@ -52,7 +53,10 @@ void osd_on_view_destroy(struct view *view);
 void osd_field_get_content(struct window_switcher_field *field,
 	struct buf *buf, struct view *view);
 
-/* Used by rcxml.c when parsing the config */
+/*
+ * Used by rcxml.c when parsing the config. osd_field_validate() also
+ * compiles the format of custom fields.
+ */
 struct window_switcher_field *osd_field_create(void);
 void osd_field_arg_from_xml_node(struct window_switcher_field *field,
 	const char *nodename, const char *content);
@@ -28,6 +28,11 @@ struct ssd_button {
 	 * nodes[state_set] should be displayed.
 	 */
 	struct wlr_scene_node *nodes[LAB_BS_ALL + 1];
+	/*
+	 * Theme icons backing nodes[], rendered for the output scale.
+	 * NULL for the window icon button, which uses plain buffers.
+	 */
+	struct scaled_scene_buffer *icons[LAB_BS_ALL + 1];
 
 	struct wl_listener destroy;
 };
@@ -71,6 +76,10 @@ struct ssd {
 		 */
 		bool was_squared;
 
+		/* Theme metrics the decorations were last laid out for */
+		int border_width;
+		int corner_width;
+
 		struct wlr_box geometry;
 		struct ssd_state_title {
 			char *text;
@@ -90,6 +99,8 @@ struct ssd {
 		struct wlr_scene_tree *tree;
 		struct ssd_sub_tree active;
 		struct ssd_sub_tree inactive;
+		/* Pending window icon lookup, if any */
+		struct icon_request *icon_request;
 	} titlebar;
 
 	/* Borders allow resizing as well */
@@ -130,6 +141,7 @@ struct ssd_hover_state {
 	struct ssd_button *button;
 };
 
+struct scaled_scene_buffer;
 struct wlr_buffer;
 struct wlr_scene_tree;
 
@@ -145,11 +157,12 @@ struct ssd_part *add_scene_buffer(
 	struct wl_list *list, enum ssd_part_type type,
 	struct wlr_scene_tree *parent, struct wlr_buffer *buffer, int x, int y);
 struct ssd_part *add_scene_button(struct wl_list *part_list,
-	enum ssd_part_type type, struct wlr_scene_tree *parent,
-	struct lab_data_buffer *buffers[LAB_BS_ALL + 1], int x, int y,
-	struct view *view);
+	enum ssd_part_type type, struct wlr_scene_tree *parent, int active,
+	int x, int y, struct view *view);
 void update_window_icon_buffer(struct wlr_scene_node *button_node,
 	struct lab_data_buffer *buffer);
+bool scene_button_matches_theme(struct ssd_part *button_root, int active);
+void update_scene_button(struct ssd_part *button_root, int active);
 
 /* SSD internal helpers */
 struct ssd_part *ssd_get_part(
@@ -160,11 +173,14 @@ void ssd_destroy_parts(struct wl_list *list);
 void ssd_titlebar_create(struct ssd *ssd);
 void ssd_titlebar_update(struct ssd *ssd);
 void ssd_titlebar_destroy(struct ssd *ssd);
+bool ssd_titlebar_can_apply_theme(struct ssd *ssd);
+void ssd_titlebar_apply_theme(struct ssd *ssd);
 bool ssd_should_be_squared(struct ssd *ssd);
 
 void ssd_border_create(struct ssd *ssd);
 void ssd_border_update(struct ssd *ssd);
 void ssd_border_destroy(struct ssd *ssd);
+void ssd_border_apply_theme(struct ssd *ssd);
 
 void ssd_extents_create(struct ssd *ssd);
 void ssd_extents_update(struct ssd *ssd);
@@ -173,5 +189,7 @@ void ssd_extents_destroy(struct ssd *ssd);
 void ssd_shadow_create(struct ssd *ssd);
 void ssd_shadow_update(struct ssd *ssd);
 void ssd_shadow_destroy(struct ssd *ssd);
+bool ssd_shadow_can_apply_theme(struct ssd *ssd);
+void ssd_shadow_apply_theme(struct ssd *ssd);
 
 #endif /* LABWC_SSD_INTERNAL_H */
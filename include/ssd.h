@@ -93,6 +93,11 @@ void ssd_set_active(struct ssd *ssd, bool active);
 void ssd_update_title(struct ssd *ssd);
 void ssd_update_geometry(struct ssd *ssd);
 void ssd_destroy(struct ssd *ssd);
+/*
+ * Update the decorations in place after the theme has been reloaded.
+ * Returns false if they need to be recreated instead.
+ */
+bool ssd_apply_theme(struct ssd *ssd);
 void ssd_set_titlebar(struct ssd *ssd, bool enabled);
 void ssd_update_window_icon(struct ssd *ssd);
 
@@ -9,7 +9,9 @@
 #define LABWC_THEME_H
 
 #include <stdio.h>
+#include <wayland-server-core.h>
 #include <wlr/render/wlr_renderer.h>
+#include "common/buf.h"
 #include "ssd.h"
 
 enum lab_justification {
@@ -45,6 +47,8 @@ struct theme {
 	int window_titlebar_padding_height;
 
 	int title_height;
+	/* rc.corner_radius, limited to fit within the titlebar */
+	int corner_radius;
 	int menu_overlap_x;
 	int menu_overlap_y;
 
@@ -132,6 +136,16 @@ struct theme {
 		struct lab_data_buffer *buttons
 			[LAB_SSD_BUTTON_LAST + 1][LAB_BS_ALL + 1];
 
+		/*
+		 * How each of the buttons above was created, so that it can
+		 * be rendered again for output scales > 1. Rounded variants
+		 * are always derived from their unrounded counterpart.
+		 */
+		struct theme_button_source {
+			char *svg_filename; /* NULL for other formats */
+			bool hover_fallback; /* overlay on non-hover variant */
+		} button_sources[LAB_SSD_BUTTON_LAST + 1][LAB_BS_ALL + 1];
+
 		/* TODO: add toggled/hover/pressed/disabled colors for buttons */
 		float button_colors[LAB_SSD_BUTTON_LAST + 1][4];
 
@@ -139,6 +153,9 @@ struct theme {
 
 	} window[2]; /* indexed by THEME_INACTIVE and THEME_ACTIVE */
 
+	/* buttons rendered on demand by theme_get_button() */
+	struct wl_list scaled_buttons; /* struct scaled_button.link */
+
 	/* textures */
 
 	struct lab_data_buffer *corner_top_left_active_normal;
@@ -162,6 +179,9 @@ struct theme {
 	/* magnifier */
 	float mag_border_color[4];
 	int mag_border_width;
+
+	/* what the theme was built from, see theme_needs_reload() */
+	struct buf snapshot;
 };
 
 #define THEME_INACTIVE 0
@@ -178,6 +198,33 @@ struct server;
  */
 void theme_init(struct theme *theme, struct server *server, const char *theme_name);
 
+/**
+ * theme_needs_reload - check whether theme_init() would give a different
+ * result than when it last ran
+ * @theme: theme data
+ * @theme_name: theme-name as passed to theme_init()
+ *
+ * This takes the theme files, themerc-override and the rc.xml options the
+ * theme or the window decorations drawn with it depend on into account.
+ */
+bool theme_needs_reload(struct theme *theme, const char *theme_name);
+
+/**
+ * theme_get_button - get button texture for an output scale
+ * @theme: theme data
+ * @active: THEME_ACTIVE or THEME_INACTIVE
+ * @type: button type
+ * @state_set: combination of enum lab_button_state
+ * @scale: output scale
+ *
+ * Buttons from SVG files (and their hover/rounded variants) are rendered
+ * for the requested scale on first use and kept until theme_finish().
+ * For other buttons, or scale <= 1, this returns the buttons[][] texture.
+ * The returned buffer is owned by the theme.
+ */
+struct lab_data_buffer *theme_get_button(struct theme *theme, int active,
+	enum ssd_part_type type, uint8_t state_set, double scale);
+
 /**
  * theme_finish - free button textures
  * @theme: theme data
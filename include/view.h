@@ -2,6 +2,7 @@
 #ifndef LABWC_VIEW_H
 #define LABWC_VIEW_H
 
+#include "common/match.h"
 #include "config/rcxml.h"
 #include "config.h"
 #include "ssd.h"
@@ -110,6 +111,7 @@ enum window_type {
 };
 
 struct view;
+struct wlr_security_context_v1_state;
 struct wlr_surface;
 
 /* Common to struct view and struct xwayland_unmanaged */
@@ -168,6 +170,19 @@ struct view {
 	const struct view_impl *impl;
 	struct wl_list link;
 
+	/*
+	 * Position in the stacking order. Higher values are closer to the
+	 * front, so server->views is always sorted by decreasing serial.
+	 */
+	int64_t stack_serial;
+	/*
+	 * Per-workspace index of server->views, see struct workspace.views.
+	 * workspace_list points to the list the view is currently in or is
+	 * NULL for always-on-bottom views which are in none.
+	 */
+	struct wl_list workspace_link;
+	struct wl_list *workspace_list;
+
 	/*
 	 * The primary output that the view is displayed on. Specifically:
 	 *
@@ -248,17 +263,32 @@ struct view {
 	 */
 	struct wlr_box last_layout_geometry;
 
+	/* Memoized window rule matches, see window-rules.c */
+	struct {
+		unsigned int generation;
+		struct wl_array matches; /* uint32_t bitset of rule indices */
+	} window_rules;
+
 	/* used by xdg-shell views */
 	uint32_t pending_configure_serial;
 	struct wl_event_source *pending_configure_timeout;
 
+	/*
+	 * Set when an output layout change sent this view a configure and
+	 * rendering is held back until the client has responded to it.
+	 * Cleared on ack+commit (xdg-shell) or the next commit (xwayland).
+	 */
+	bool awaits_layout_change;
+
 	struct ssd *ssd;
 	struct resize_indicator {
 		int width, height;
 		struct wlr_scene_tree *tree;
 		struct wlr_scene_rect *border;
 		struct wlr_scene_rect *background;
-		struct scaled_font_buffer *text;
+		struct scaled_scene_buffer *text;
+		/* 12345 x 12345 would be 13 chars + 1 null byte */
+		char label[32];
 	} resize_indicator;
 	struct resize_outlines {
 		struct wlr_box view_geo;
@@ -305,6 +335,15 @@ struct view_query {
 	char *desktop;
 	enum ssd_mode decoration;
 	char *monitor;
+
+	/* Compiled on first use by view_matches_query() */
+	bool compiled;
+	struct wl_array ops; /* enum view_query_op, cheapest first */
+	struct glob_matcher identifier_matcher;
+	struct glob_matcher title_matcher;
+	struct glob_matcher sandbox_engine_matcher;
+	struct glob_matcher sandbox_app_id_matcher;
+	struct glob_matcher tiled_region_matcher;
 };
 
 struct xdg_toplevel_view {
@@ -385,7 +424,10 @@ bool view_matches_query(struct view *view, struct view_query *query);
 
 /**
  * view_next() - Get next view which matches criteria.
- * @head: Head of list to iterate over.
+ * @head: Head of list to iterate over. Must be &server->views when
+ *	  %LAB_VIEW_CRITERIA_CURRENT_WORKSPACE is given, in which case only the
+ *	  views of the current workspace and the always-on-top views are
+ *	  visited rather than filtering the whole list.
  * @view: Current view from which to find the next one. If NULL is provided as
  *	  the view argument, the start of the list will be used.
  * @criteria: Criteria to match against.
@@ -432,6 +474,8 @@ void view_array_append(struct server *server, struct wl_array *views,
 
 enum view_wants_focus view_wants_focus(struct view *view);
 bool view_contains_window_type(struct view *view, enum window_type window_type);
+const struct wlr_security_context_v1_state *security_context_from_view(
+	struct view *view);
 
 /**
  * view_edge_invert() - select the opposite of a provided edge
@@ -538,6 +582,18 @@ bool view_is_tiled(struct view *view);
 bool view_is_tiled_and_notify_tiled(struct view *view);
 bool view_is_floating(struct view *view);
 void view_move_to_workspace(struct view *view, struct workspace *workspace);
+
+/**
+ * view_stack_add() - Insert a newly created view at the front of
+ * server->views and the matching workspace list.
+ */
+void view_stack_add(struct view *view);
+
+/**
+ * view_stack_move() - Move view to the front or back of server->views and
+ * the matching workspace list. Does not touch the scene-graph.
+ */
+void view_stack_move(struct view *view, bool to_front);
 enum ssd_mode view_get_ssd_mode(struct view *view);
 void view_set_ssd_mode(struct view *view, enum ssd_mode mode);
 void view_set_decorations(struct view *view, enum ssd_mode mode, bool force_ssd);
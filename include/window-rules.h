@@ -4,6 +4,7 @@
 
 #include <stdbool.h>
 #include <wayland-util.h>
+#include "common/match.h"
 
 enum window_rule_event {
 	LAB_WINDOW_RULE_EVENT_ON_FIRST_MAP = 0,
@@ -39,11 +40,25 @@ struct window_rule {
 	enum property ignore_configure_request;
 	enum property fixed_position;
 
+	/* Set up by window_rules_init() */
+	int index;
+	struct glob_matcher identifier_matcher;
+	struct glob_matcher title_matcher;
+	struct glob_matcher sandbox_engine_matcher;
+	struct glob_matcher sandbox_app_id_matcher;
+
 	struct wl_list link; /* struct rcxml.window_rules */
 };
 
 struct view;
 
+/* Compile rc.window_rules after (re-)loading the config */
+void window_rules_init(void);
+void window_rules_finish(void);
+
+/* Must be called when the app_id or title of a view changes */
+void window_rules_invalidate(struct view *view);
+
 void window_rules_apply(struct view *view, enum window_rule_event event);
 enum property window_rules_get_property(struct view *view, const char *property);
 
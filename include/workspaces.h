@@ -20,6 +20,11 @@ struct workspace {
 
 	char *name;
 	struct wlr_scene_tree *tree;
+	/*
+	 * struct view.workspace_link of the views whose scene-tree is a child
+	 * of this workspace, in the same order as server->views
+	 */
+	struct wl_list views;
 
 	struct lab_cosmic_workspace *cosmic_workspace;
 	struct {
@@ -71,6 +71,13 @@ struct xwayland_view {
 	struct wl_listener set_window_type;
 	struct wl_listener map_request;
 
+	/* Coalesces ConfigureWindow requests, see xwayland_view_configure() */
+	struct wl_event_source *configure_idle;
+	struct wlr_box configure_geo;
+
+	/* Link to server.xwayland_stack, see xwayland_adjust_stacking_order() */
+	struct wl_list stack_link;
+
 	/* Not (yet) implemented */
 /*	struct wl_listener set_role; */
 /*	struct wl_listener set_hints; */
@@ -2,6 +2,7 @@
 #define _POSIX_C_SOURCE 200809L
 #include <assert.h>
 #include <signal.h>
+#include <stdlib.h>
 #include <string.h>
 #include <strings.h>
 #include <unistd.h>
@@ -33,10 +34,73 @@ enum action_arg_type {
 	LAB_ACTION_ARG_ACTION_LIST,
 };
 
+enum action_arg_key {
+	ACTION_ARG_INVALID = 0,
+	ACTION_ARG_COMMAND,
+	ACTION_ARG_DIRECTION,
+	ACTION_ARG_SNAP_WINDOWS,
+	ACTION_ARG_MENU,
+	ACTION_ARG_AT_CURSOR,
+	ACTION_ARG_X_POSITION,
+	ACTION_ARG_Y_POSITION,
+	ACTION_ARG_DECORATIONS,
+	ACTION_ARG_FORCE_SSD,
+	ACTION_ARG_LEFT,
+	ACTION_ARG_RIGHT,
+	ACTION_ARG_TOP,
+	ACTION_ARG_BOTTOM,
+	ACTION_ARG_X,
+	ACTION_ARG_Y,
+	ACTION_ARG_WIDTH,
+	ACTION_ARG_HEIGHT,
+	ACTION_ARG_FOLLOW,
+	ACTION_ARG_TO,
+	ACTION_ARG_WRAP,
+	ACTION_ARG_REGION,
+	ACTION_ARG_OUTPUT,
+	ACTION_ARG_OUTPUT_NAME,
+	ACTION_ARG_POLICY,
+	ACTION_ARG_QUERY,
+	ACTION_ARG_THEN,
+	ACTION_ARG_ELSE,
+	ACTION_ARG_NONE,
+};
+
+static const char * const action_arg_keys[] = {
+	[ACTION_ARG_COMMAND] = "command",
+	[ACTION_ARG_DIRECTION] = "direction",
+	[ACTION_ARG_SNAP_WINDOWS] = "snapWindows",
+	[ACTION_ARG_MENU] = "menu",
+	[ACTION_ARG_AT_CURSOR] = "atCursor",
+	[ACTION_ARG_X_POSITION] = "x.position",
+	[ACTION_ARG_Y_POSITION] = "y.position",
+	[ACTION_ARG_DECORATIONS] = "decorations",
+	[ACTION_ARG_FORCE_SSD] = "forceSSD",
+	[ACTION_ARG_LEFT] = "left",
+	[ACTION_ARG_RIGHT] = "right",
+	[ACTION_ARG_TOP] = "top",
+	[ACTION_ARG_BOTTOM] = "bottom",
+	[ACTION_ARG_X] = "x",
+	[ACTION_ARG_Y] = "y",
+	[ACTION_ARG_WIDTH] = "width",
+	[ACTION_ARG_HEIGHT] = "height",
+	[ACTION_ARG_FOLLOW] = "follow",
+	[ACTION_ARG_TO] = "to",
+	[ACTION_ARG_WRAP] = "wrap",
+	[ACTION_ARG_REGION] = "region",
+	[ACTION_ARG_OUTPUT] = "output",
+	[ACTION_ARG_OUTPUT_NAME] = "output_name",
+	[ACTION_ARG_POLICY] = "policy",
+	[ACTION_ARG_QUERY] = "query",
+	[ACTION_ARG_THEN] = "then",
+	[ACTION_ARG_ELSE] = "else",
+	[ACTION_ARG_NONE] = "none",
+};
+
 struct action_arg {
 	struct wl_list link;        /* struct action.args */
 
-	char *key;                  /* May be NULL if there is just one arg */
+	enum action_arg_key key;
 	enum action_arg_type type;
 };
 
@@ -189,6 +253,21 @@ const char *action_names[] = {
 	NULL
 };
 
+/*
+ * Argument names are only looked at while parsing the config. Actions
+ * then find their arguments by enum action_arg_key when they run.
+ */
+static enum action_arg_key
+action_arg_key_from_str(const char *key)
+{
+	for (size_t i = 1; i < ARRAY_SIZE(action_arg_keys); i++) {
+		if (!strcasecmp(key, action_arg_keys[i])) {
+			return i;
+		}
+	}
+	return ACTION_ARG_INVALID;
+}
+
 void
 action_arg_add_str(struct action *action, const char *key, const char *value)
 {
@@ -197,7 +276,8 @@ action_arg_add_str(struct action *action, const char *key, const char *value)
 	assert(value && "Tried to add NULL action string argument");
 	struct action_arg_str *arg = znew(*arg);
 	arg->base.type = LAB_ACTION_ARG_STR;
-	arg->base.key = xstrdup(key);
+	arg->base.key = action_arg_key_from_str(key);
+	assert(arg->base.key != ACTION_ARG_INVALID);
 	arg->value = xstrdup(value);
 	wl_list_append(&action->args, &arg->base.link);
 }
@@ -209,7 +289,8 @@ action_arg_add_bool(struct action *action, const char *key, bool value)
 	assert(key);
 	struct action_arg_bool *arg = znew(*arg);
 	arg->base.type = LAB_ACTION_ARG_BOOL;
-	arg->base.key = xstrdup(key);
+	arg->base.key = action_arg_key_from_str(key);
+	assert(arg->base.key != ACTION_ARG_INVALID);
 	arg->value = value;
 	wl_list_append(&action->args, &arg->base.link);
 }
@@ -221,7 +302,8 @@ action_arg_add_int(struct action *action, const char *key, int value)
 	assert(key);
 	struct action_arg_int *arg = znew(*arg);
 	arg->base.type = LAB_ACTION_ARG_INT;
-	arg->base.key = xstrdup(key);
+	arg->base.key = action_arg_key_from_str(key);
+	assert(arg->base.key != ACTION_ARG_INVALID);
 	arg->value = value;
 	wl_list_append(&action->args, &arg->base.link);
 }
@@ -233,7 +315,8 @@ action_arg_add_list(struct action *action, const char *key, enum action_arg_type
 	assert(key);
 	struct action_arg_list *arg = znew(*arg);
 	arg->base.type = type;
-	arg->base.key = xstrdup(key);
+	arg->base.key = action_arg_key_from_str(key);
+	assert(arg->base.key != ACTION_ARG_INVALID);
 	wl_list_init(&arg->value);
 	wl_list_append(&action->args, &arg->base.link);
 }
@@ -251,13 +334,13 @@ action_arg_add_actionlist(struct action *action, const char *key)
 }
 
 static void *
-action_get_arg(struct action *action, const char *key, enum action_arg_type type)
+action_get_arg(struct action *action, enum action_arg_key key,
+		enum action_arg_type type)
 {
 	assert(action);
-	assert(key);
 	struct action_arg *arg;
 	wl_list_for_each(arg, &action->args, link) {
-		if (!strcasecmp(key, arg->key) && arg->type == type) {
+		if (arg->key == key && arg->type == type) {
 			return arg;
 		}
 	}
@@ -265,38 +348,46 @@ action_get_arg(struct action *action, const char *key, enum action_arg_type type
 }
 
 static const char *
-action_get_str(struct action *action, const char *key, const char *default_value)
+action_get_str(struct action *action, enum action_arg_key key, const char *default_value)
 {
 	struct action_arg_str *arg = action_get_arg(action, key, LAB_ACTION_ARG_STR);
 	return arg ? arg->value : default_value;
 }
 
 static bool
-action_get_bool(struct action *action, const char *key, bool default_value)
+action_get_bool(struct action *action, enum action_arg_key key, bool default_value)
 {
 	struct action_arg_bool *arg = action_get_arg(action, key, LAB_ACTION_ARG_BOOL);
 	return arg ? arg->value : default_value;
 }
 
 static int
-action_get_int(struct action *action, const char *key, int default_value)
+action_get_int(struct action *action, enum action_arg_key key, int default_value)
 {
 	struct action_arg_int *arg = action_get_arg(action, key, LAB_ACTION_ARG_INT);
 	return arg ? arg->value : default_value;
 }
 
+static struct wl_list *
+action_get_list(struct action *action, enum action_arg_key key,
+		enum action_arg_type type)
+{
+	struct action_arg_list *arg = action_get_arg(action, key, type);
+	return arg ? &arg->value : NULL;
+}
+
 struct wl_list *
 action_get_querylist(struct action *action, const char *key)
 {
-	struct action_arg_list *arg = action_get_arg(action, key, LAB_ACTION_ARG_QUERY_LIST);
-	return arg ? &arg->value : NULL;
+	return action_get_list(action, action_arg_key_from_str(key),
+		LAB_ACTION_ARG_QUERY_LIST);
 }
 
 struct wl_list *
 action_get_actionlist(struct action *action, const char *key)
 {
-	struct action_arg_list *arg = action_get_arg(action, key, LAB_ACTION_ARG_ACTION_LIST);
-	return arg ? &arg->value : NULL;
+	return action_get_list(action, action_arg_key_from_str(key),
+		LAB_ACTION_ARG_ACTION_LIST);
 }
 
 void
@@ -484,13 +575,38 @@ cleanup:
 	free(argument);
 }
 
+static int
+compare_action_types(const void *a, const void *b)
+{
+	return strcasecmp(action_names[*(const enum action_type *)a],
+		action_names[*(const enum action_type *)b]);
+}
+
+static int
+compare_action_name(const void *key, const void *type)
+{
+	return strcasecmp(key, action_names[*(const enum action_type *)type]);
+}
+
 static enum action_type
 action_type_from_str(const char *action_name)
 {
-	for (size_t i = 1; action_names[i]; i++) {
-		if (!strcasecmp(action_name, action_names[i])) {
-			return i;
+	/* Action types sorted by name, for binary search */
+	static enum action_type sorted[ARRAY_SIZE(action_names) - 2];
+	static bool initialized;
+	if (!initialized) {
+		for (size_t i = 0; i < ARRAY_SIZE(sorted); i++) {
+			sorted[i] = i + 1;
 		}
+		qsort(sorted, ARRAY_SIZE(sorted), sizeof(sorted[0]),
+			compare_action_types);
+		initialized = true;
+	}
+
+	enum action_type *type = bsearch(action_name, sorted,
+		ARRAY_SIZE(sorted), sizeof(sorted[0]), compare_action_name);
+	if (type) {
+		return *type;
 	}
 	wlr_log(WLR_ERROR, "Invalid action: %s", action_name);
 	return ACTION_TYPE_INVALID;
@@ -545,41 +661,45 @@ action_list_is_valid(struct wl_list *actions)
 bool
 action_is_valid(struct action *action)
 {
-	const char *arg_name = NULL;
+	enum action_arg_key arg_key = ACTION_ARG_INVALID;
 	enum action_arg_type arg_type = LAB_ACTION_ARG_STR;
 
 	switch (action->type) {
 	case ACTION_TYPE_EXECUTE:
-		arg_name = "command";
+		arg_key = ACTION_ARG_COMMAND;
 		break;
 	case ACTION_TYPE_MOVE_TO_EDGE:
 	case ACTION_TYPE_TOGGLE_SNAP_TO_EDGE:
 	case ACTION_TYPE_SNAP_TO_EDGE:
 	case ACTION_TYPE_GROW_TO_EDGE:
 	case ACTION_TYPE_SHRINK_TO_EDGE:
-		arg_name = "direction";
+		arg_key = ACTION_ARG_DIRECTION;
 		arg_type = LAB_ACTION_ARG_INT;
 		break;
 	case ACTION_TYPE_SHOW_MENU:
-		arg_name = "menu";
+		arg_key = ACTION_ARG_MENU;
 		break;
 	case ACTION_TYPE_GO_TO_DESKTOP:
 	case ACTION_TYPE_SEND_TO_DESKTOP:
-		arg_name = "to";
+		arg_key = ACTION_ARG_TO;
 		break;
 	case ACTION_TYPE_TOGGLE_SNAP_TO_REGION:
 	case ACTION_TYPE_SNAP_TO_REGION:
-		arg_name = "region";
+		arg_key = ACTION_ARG_REGION;
 		break;
 	case ACTION_TYPE_IF:
 	case ACTION_TYPE_FOR_EACH:
 		; /* works around "a label can only be part of a statement" */
-		static const char * const branches[] = { "then", "else", "none" };
+		static const enum action_arg_key branches[] = {
+			ACTION_ARG_THEN, ACTION_ARG_ELSE, ACTION_ARG_NONE
+		};
 		for (size_t i = 0; i < ARRAY_SIZE(branches); i++) {
-			struct wl_list *children = action_get_actionlist(action, branches[i]);
+			struct wl_list *children = action_get_list(action,
+				branches[i], LAB_ACTION_ARG_ACTION_LIST);
 			if (children && !action_list_is_valid(children)) {
 				wlr_log(WLR_ERROR, "Invalid action in %s '%s' branch",
-					action_names[action->type], branches[i]);
+					action_names[action->type],
+					action_arg_keys[branches[i]]);
 				return false;
 			}
 		}
@@ -589,12 +709,12 @@ action_is_valid(struct action *action)
 		return true;
 	}
 
-	if (action_get_arg(action, arg_name, arg_type)) {
+	if (action_get_arg(action, arg_key, arg_type)) {
 		return true;
 	}
 
 	wlr_log(WLR_ERROR, "Missing required argument for %s: %s",
-		action_names[action->type], arg_name);
+		action_names[action->type], action_arg_keys[arg_key]);
 	return false;
 }
 
@@ -605,7 +725,6 @@ action_free(struct action *action)
 	struct action_arg *arg, *arg_tmp;
 	wl_list_for_each_safe(arg, arg_tmp, &action->args, link) {
 		wl_list_remove(&arg->link);
-		zfree(arg->key);
 		if (arg->type == LAB_ACTION_ARG_STR) {
 			struct action_arg_str *str_arg = (struct action_arg_str *)arg;
 			zfree(str_arg->value);
@@ -761,30 +880,48 @@ view_for_action(struct view *activator, struct server *server,
 	}
 }
 
+/* Arguments of If and ForEach, looked up once per action run */
+struct if_action_args {
+	struct wl_list *queries;
+	struct wl_list *then_actions;
+	struct wl_list *else_actions;
+};
+
+static void
+get_if_action_args(struct action *action, struct if_action_args *args)
+{
+	args->queries = action_get_list(action, ACTION_ARG_QUERY,
+		LAB_ACTION_ARG_QUERY_LIST);
+	args->then_actions = action_get_list(action, ACTION_ARG_THEN,
+		LAB_ACTION_ARG_ACTION_LIST);
+	args->else_actions = action_get_list(action, ACTION_ARG_ELSE,
+		LAB_ACTION_ARG_ACTION_LIST);
+}
+
 static bool
-run_if_action(struct view *view, struct server *server, struct action *action)
+run_if_action(struct view *view, struct server *server,
+		struct if_action_args *args)
 {
 	struct view_query *query;
-	struct wl_list *queries, *actions;
-	const char *branch = "then";
+	bool matches = true;
 
-	queries = action_get_querylist(action, "query");
-	if (queries) {
-		branch = "else";
+	if (args->queries) {
+		matches = false;
 		/* All queries are OR'ed */
-		wl_list_for_each(query, queries, link) {
+		wl_list_for_each(query, args->queries, link) {
 			if (view_matches_query(view, query)) {
-				branch = "then";
+				matches = true;
 				break;
 			}
 		}
 	}
 
-	actions = action_get_actionlist(action, branch);
+	struct wl_list *actions =
+		matches ? args->then_actions : args->else_actions;
 	if (actions) {
 		actions_run(view, server, actions, NULL);
 	}
-	return !strcmp(branch, "then");
+	return matches;
 }
 
 static bool
@@ -811,15 +948,15 @@ static struct output *
 get_target_output(struct output *output, struct server *server,
 	struct action *action)
 {
-	const char *output_name = action_get_str(action, "output", NULL);
+	const char *output_name = action_get_str(action, ACTION_ARG_OUTPUT, NULL);
 	struct output *target = NULL;
 
 	if (output_name) {
 		target = output_from_name(server, output_name);
 	} else {
 		enum view_edge edge =
-			action_get_int(action, "direction", VIEW_EDGE_INVALID);
-		bool wrap = action_get_bool(action, "wrap", false);
+			action_get_int(action, ACTION_ARG_DIRECTION, VIEW_EDGE_INVALID);
+		bool wrap = action_get_bool(action, ACTION_ARG_WRAP, false);
 		target = output_get_adjacent(output, edge, wrap);
 	}
 
@@ -885,7 +1022,7 @@ actions_run(struct view *activator, struct server *server,
 		case ACTION_TYPE_EXECUTE:
 			{
 				struct buf cmd = BUF_INIT;
-				buf_add(&cmd, action_get_str(action, "command", NULL));
+				buf_add(&cmd, action_get_str(action, ACTION_ARG_COMMAND, NULL));
 				buf_expand_tilde(&cmd);
 				spawn_async_no_shell(cmd.data);
 				buf_reset(&cmd);
@@ -897,8 +1034,10 @@ actions_run(struct view *activator, struct server *server,
 		case ACTION_TYPE_MOVE_TO_EDGE:
 			if (view) {
 				/* Config parsing makes sure that direction is a valid direction */
-				enum view_edge edge = action_get_int(action, "direction", 0);
-				bool snap_to_windows = action_get_bool(action, "snapWindows", true);
+				enum view_edge edge =
+					action_get_int(action, ACTION_ARG_DIRECTION, 0);
+				bool snap_to_windows = action_get_bool(action,
+					ACTION_ARG_SNAP_WINDOWS, true);
 				view_move_to_edge(view, edge, snap_to_windows);
 			}
 			break;
@@ -906,7 +1045,8 @@ actions_run(struct view *activator, struct server *server,
 		case ACTION_TYPE_SNAP_TO_EDGE:
 			if (view) {
 				/* Config parsing makes sure that direction is a valid direction */
-				enum view_edge edge = action_get_int(action, "direction", 0);
+				enum view_edge edge =
+					action_get_int(action, ACTION_ARG_DIRECTION, 0);
 				if (action->type == ACTION_TYPE_TOGGLE_SNAP_TO_EDGE
 						&& view->maximized == VIEW_AXIS_NONE
 						&& !view->fullscreen
@@ -924,14 +1064,16 @@ actions_run(struct view *activator, struct server *server,
 		case ACTION_TYPE_GROW_TO_EDGE:
 			if (view) {
 				/* Config parsing makes sure that direction is a valid direction */
-				enum view_edge edge = action_get_int(action, "direction", 0);
+				enum view_edge edge =
+					action_get_int(action, ACTION_ARG_DIRECTION, 0);
 				view_grow_to_edge(view, edge);
 			}
 			break;
 		case ACTION_TYPE_SHRINK_TO_EDGE:
 			if (view) {
 				/* Config parsing makes sure that direction is a valid direction */
-				enum view_edge edge = action_get_int(action, "direction", 0);
+				enum view_edge edge =
+					action_get_int(action, ACTION_ARG_DIRECTION, 0);
 				view_shrink_to_edge(view, edge);
 			}
 			break;
@@ -946,22 +1088,22 @@ actions_run(struct view *activator, struct server *server,
 			break;
 		case ACTION_TYPE_SHOW_MENU:
 			show_menu(server, view, &ctx,
-				action_get_str(action, "menu", NULL),
-				action_get_bool(action, "atCursor", true),
-				action_get_str(action, "x.position", NULL),
-				action_get_str(action, "y.position", NULL));
+				action_get_str(action, ACTION_ARG_MENU, NULL),
+				action_get_bool(action, ACTION_ARG_AT_CURSOR, true),
+				action_get_str(action, ACTION_ARG_X_POSITION, NULL),
+				action_get_str(action, ACTION_ARG_Y_POSITION, NULL));
 			break;
 		case ACTION_TYPE_TOGGLE_MAXIMIZE:
 			if (view) {
 				enum view_axis axis = action_get_int(action,
-					"direction", VIEW_AXIS_BOTH);
+					ACTION_ARG_DIRECTION, VIEW_AXIS_BOTH);
 				view_toggle_maximize(view, axis);
 			}
 			break;
 		case ACTION_TYPE_MAXIMIZE:
 			if (view) {
 				enum view_axis axis = action_get_int(action,
-					"direction", VIEW_AXIS_BOTH);
+					ACTION_ARG_DIRECTION, VIEW_AXIS_BOTH);
 				view_maximize(view, axis,
 					/*store_natural_geometry*/ true);
 			}
@@ -969,7 +1111,7 @@ actions_run(struct view *activator, struct server *server,
 		case ACTION_TYPE_UNMAXIMIZE:
 			if (view) {
 				enum view_axis axis = action_get_int(action,
-					"direction", VIEW_AXIS_BOTH);
+					ACTION_ARG_DIRECTION, VIEW_AXIS_BOTH);
 				view_maximize(view, view->maximized & ~axis,
 					/*store_natural_geometry*/ true);
 			}
@@ -982,9 +1124,9 @@ actions_run(struct view *activator, struct server *server,
 		case ACTION_TYPE_SET_DECORATIONS:
 			if (view) {
 				enum ssd_mode mode = action_get_int(action,
-					"decorations", LAB_SSD_MODE_FULL);
+					ACTION_ARG_DECORATIONS, LAB_SSD_MODE_FULL);
 				bool force_ssd = action_get_bool(action,
-					"forceSSD", false);
+					ACTION_ARG_FORCE_SSD, false);
 				view_set_decorations(view, mode, force_ssd);
 			}
 			break;
@@ -1046,24 +1188,24 @@ actions_run(struct view *activator, struct server *server,
 			break;
 		case ACTION_TYPE_RESIZE_RELATIVE:
 			if (view) {
-				int left = action_get_int(action, "left", 0);
-				int right = action_get_int(action, "right", 0);
-				int top = action_get_int(action, "top", 0);
-				int bottom = action_get_int(action, "bottom", 0);
+				int left = action_get_int(action, ACTION_ARG_LEFT, 0);
+				int right = action_get_int(action, ACTION_ARG_RIGHT, 0);
+				int top = action_get_int(action, ACTION_ARG_TOP, 0);
+				int bottom = action_get_int(action, ACTION_ARG_BOTTOM, 0);
 				view_resize_relative(view, left, right, top, bottom);
 			}
 			break;
 		case ACTION_TYPE_MOVETO:
 			if (view) {
-				int x = action_get_int(action, "x", 0);
-				int y = action_get_int(action, "y", 0);
+				int x = action_get_int(action, ACTION_ARG_X, 0);
+				int y = action_get_int(action, ACTION_ARG_Y, 0);
 				view_move(view, x, y);
 			}
 			break;
 		case ACTION_TYPE_RESIZETO:
 			if (view) {
-				int width = action_get_int(action, "width", 0);
-				int height = action_get_int(action, "height", 0);
+				int width = action_get_int(action, ACTION_ARG_WIDTH, 0);
+				int height = action_get_int(action, ACTION_ARG_HEIGHT, 0);
 
 				/*
 				 * To support only setting one of width/height
@@ -1082,8 +1224,8 @@ actions_run(struct view *activator, struct server *server,
 			break;
 		case ACTION_TYPE_MOVE_RELATIVE:
 			if (view) {
-				int x = action_get_int(action, "x", 0);
-				int y = action_get_int(action, "y", 0);
+				int x = action_get_int(action, ACTION_ARG_X, 0);
+				int y = action_get_int(action, ACTION_ARG_Y, 0);
 				view_move_relative(view, x, y);
 			}
 			break;
@@ -1103,8 +1245,8 @@ actions_run(struct view *activator, struct server *server,
 		case ACTION_TYPE_GO_TO_DESKTOP:
 			{
 				bool follow = true;
-				bool wrap = action_get_bool(action, "wrap", true);
-				const char *to = action_get_str(action, "to", NULL);
+				bool wrap = action_get_bool(action, ACTION_ARG_WRAP, true);
+				const char *to = action_get_str(action, ACTION_ARG_TO, NULL);
 				/*
 				 * `to` is always != NULL here because otherwise we would have
 				 * removed the action during the initial parsing step as it is
@@ -1117,7 +1259,7 @@ actions_run(struct view *activator, struct server *server,
 				}
 				if (action->type == ACTION_TYPE_SEND_TO_DESKTOP) {
 					view_move_to_workspace(view, target);
-					follow = action_get_bool(action, "follow", true);
+					follow = action_get_bool(action, ACTION_ARG_FOLLOW, true);
 
 					/* Ensure that the focus is not on another desktop */
 					if (!follow && server->active_view == view) {
@@ -1154,7 +1296,7 @@ actions_run(struct view *activator, struct server *server,
 			if (!output) {
 				break;
 			}
-			const char *region_name = action_get_str(action, "region", NULL);
+			const char *region_name = action_get_str(action, ACTION_ARG_REGION, NULL);
 			struct region *region = regions_from_name(region_name, output);
 			if (region) {
 				if (action->type == ACTION_TYPE_TOGGLE_SNAP_TO_REGION
@@ -1194,7 +1336,9 @@ actions_run(struct view *activator, struct server *server,
 			break;
 		case ACTION_TYPE_IF:
 			if (view) {
-				run_if_action(view, server, action);
+				struct if_action_args args;
+				get_if_action_args(action, &args);
+				run_if_action(view, server, &args);
 			}
 			break;
 		case ACTION_TYPE_FOR_EACH:
@@ -1202,15 +1346,17 @@ actions_run(struct view *activator, struct server *server,
 				struct wl_array views;
 				struct view **item;
 				bool matches = false;
+				struct if_action_args args;
+				get_if_action_args(action, &args);
 				wl_array_init(&views);
 				view_array_append(server, &views, LAB_VIEW_CRITERIA_NONE);
 				wl_array_for_each(item, &views) {
-					matches |= run_if_action(*item, server, action);
+					matches |= run_if_action(*item, server, &args);
 				}
 				wl_array_release(&views);
 				if (!matches) {
-					struct wl_list *actions;
-					actions = action_get_actionlist(action, "none");
+					struct wl_list *actions = action_get_list(action,
+						ACTION_ARG_NONE, LAB_ACTION_ARG_ACTION_LIST);
 					if (actions) {
 						actions_run(view, server, actions, NULL);
 					}
@@ -1219,23 +1365,24 @@ actions_run(struct view *activator, struct server *server,
 			break;
 		case ACTION_TYPE_VIRTUAL_OUTPUT_ADD:
 			{
-				const char *output_name = action_get_str(action, "output_name",
-						NULL);
+				const char *output_name = action_get_str(action,
+					ACTION_ARG_OUTPUT_NAME, NULL);
 				output_virtual_add(server, output_name,
 					/*store_wlr_output*/ NULL);
 			}
 			break;
 		case ACTION_TYPE_VIRTUAL_OUTPUT_REMOVE:
 			{
-				const char *output_name = action_get_str(action, "output_name",
-						NULL);
+				const char *output_name = action_get_str(action,
+					ACTION_ARG_OUTPUT_NAME, NULL);
 				output_virtual_remove(server, output_name);
 			}
 			break;
 		case ACTION_TYPE_AUTO_PLACE:
 			if (view) {
 				enum view_placement_policy policy =
-					action_get_int(action, "policy", LAB_PLACE_AUTOMATIC);
+					action_get_int(action, ACTION_ARG_POLICY,
+						LAB_PLACE_AUTOMATIC);
 				view_place_by_policy(view,
 					/* allow_cursor */ true, policy);
 			}
@@ -1276,13 +1423,14 @@ actions_run(struct view *activator, struct server *server,
 			}
 			break;
 		case ACTION_TYPE_ENABLE_TABLET_MOUSE_EMULATION:
-			rc.tablet.force_mouse_emulation = true;
+			server->seat.force_tablet_mouse_emulation = true;
 			break;
 		case ACTION_TYPE_DISABLE_TABLET_MOUSE_EMULATION:
-			rc.tablet.force_mouse_emulation = false;
+			server->seat.force_tablet_mouse_emulation = false;
 			break;
 		case ACTION_TYPE_TOGGLE_TABLET_MOUSE_EMULATION:
-			rc.tablet.force_mouse_emulation = !rc.tablet.force_mouse_emulation;
+			server->seat.force_tablet_mouse_emulation =
+				!server->seat.force_tablet_mouse_emulation;
 			break;
 		case ACTION_TYPE_TOGGLE_MAGNIFY:
 			magnify_toggle(server);
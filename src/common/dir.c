@@ -4,7 +4,9 @@
  *
  * Copyright Johan Malm 2020
  */
+#define _POSIX_C_SOURCE 200809L
 #include <assert.h>
+#include <dirent.h>
 #include <glib.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -190,3 +192,41 @@ paths_destroy(struct wl_list *paths)
 		free(path);
 	}
 }
+
+static void
+stat_snapshot_add(struct buf *snapshot, const char *path)
+{
+	struct stat st;
+	if (stat(path, &st)) {
+		buf_add_fmt(snapshot, "%s -\n", path);
+		return;
+	}
+	buf_add_fmt(snapshot, "%s %lld %lld.%09ld\n", path,
+		(long long)st.st_size, (long long)st.st_mtim.tv_sec,
+		st.st_mtim.tv_nsec);
+}
+
+void
+paths_stat_snapshot(struct wl_list *paths, struct buf *snapshot)
+{
+	struct path *path;
+	wl_list_for_each(path, paths, link) {
+		stat_snapshot_add(snapshot, path->string);
+
+		DIR *dir = opendir(path->string);
+		if (!dir) {
+			continue;
+		}
+		struct dirent *entry;
+		while ((entry = readdir(dir))) {
+			if (entry->d_name[0] == '.') {
+				continue;
+			}
+			char *file = strdup_printf("%s/%s", path->string,
+				entry->d_name);
+			stat_snapshot_add(snapshot, file);
+			free(file);
+		}
+		closedir(dir);
+	}
+}
@@ -0,0 +1,256 @@
+// SPDX-License-Identifier: GPL-2.0-only
+#define _POSIX_C_SOURCE 200809L
+#include <assert.h>
+#include <cairo.h>
+#include <math.h>
+#include <pango/pangocairo.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wayland-util.h>
+#include <wlr/util/log.h>
+#include "buffer.h"
+#include "common/array.h"
+#include "common/font.h"
+#include "common/glyph-atlas.h"
+#include "common/graphic-helpers.h"
+#include "common/macros.h"
+#include "common/mem.h"
+#include "common/string-helpers.h"
+
+/* All glyphs rendered for one output scale, in device pixels */
+struct glyph_strip {
+	double scale;
+	int slot_width;
+	/* Space left of each glyph origin for ink reaching past it */
+	int pad;
+	int height;
+	cairo_surface_t *surface;
+};
+
+struct glyph_atlas {
+	char *glyphs;
+	int nr_glyphs;
+	/* Logical advance of each glyph in layout pixels */
+	double *advances;
+	double max_advance;
+	int height;
+	/* Index + 1 into glyphs for each byte, 0 if not in the atlas */
+	uint8_t slot[256];
+
+	struct font font;
+	float color[4];
+	float bg_color[4];
+
+	struct wl_array strips; /* struct glyph_strip */
+};
+
+static PangoLayout *
+create_layout(cairo_t *cairo, struct font *font)
+{
+	PangoLayout *layout = pango_cairo_create_layout(cairo);
+	pango_context_set_round_glyph_positions(
+		pango_layout_get_context(layout), false);
+	pango_layout_set_single_paragraph_mode(layout, TRUE);
+	pango_layout_set_width(layout, -1);
+
+	PangoFontDescription *desc = font_to_pango_desc(font);
+	pango_layout_set_font_description(layout, desc);
+	pango_font_description_free(desc);
+	return layout;
+}
+
+static void
+measure_glyphs(struct glyph_atlas *atlas)
+{
+	cairo_surface_t *surface =
+		cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 1, 1);
+	cairo_t *cairo = cairo_create(surface);
+	PangoLayout *layout = create_layout(cairo, &atlas->font);
+
+	for (int i = 0; i < atlas->nr_glyphs; i++) {
+		PangoRectangle logical;
+		pango_layout_set_text(layout, &atlas->glyphs[i], 1);
+		pango_layout_get_extents(layout, NULL, &logical);
+
+		atlas->advances[i] = (double)logical.width / PANGO_SCALE;
+		atlas->max_advance = MAX(atlas->max_advance, atlas->advances[i]);
+		pango_extents_to_pixels(&logical, NULL);
+		atlas->height = MAX(atlas->height, logical.height);
+	}
+
+	g_object_unref(layout);
+	cairo_destroy(cairo);
+	cairo_surface_destroy(surface);
+}
+
+static struct glyph_strip *
+get_strip(struct glyph_atlas *atlas, double scale)
+{
+	struct glyph_strip *strip;
+	wl_array_for_each(strip, &atlas->strips) {
+		if (strip->scale == scale) {
+			return strip;
+		}
+	}
+
+	struct glyph_strip new_strip = {
+		.scale = scale,
+		.pad = (int)ceil(atlas->height * scale / 4),
+		.height = (int)lround(atlas->height * scale),
+	};
+	new_strip.slot_width = (int)ceil(atlas->max_advance * scale)
+		+ 2 * new_strip.pad;
+	new_strip.surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+		new_strip.slot_width * atlas->nr_glyphs, new_strip.height);
+
+	/*
+	 * Render at device resolution so that pango hints for the right
+	 * size, then reset the device scale so that the strip can be used
+	 * as a pixel-exact source.
+	 */
+	cairo_surface_set_device_scale(new_strip.surface, scale, scale);
+	cairo_t *cairo = cairo_create(new_strip.surface);
+	set_cairo_color(cairo, atlas->color);
+	PangoLayout *layout = create_layout(cairo, &atlas->font);
+
+	/*
+	 * Glyphs are composited onto each other's padding, so they are
+	 * rendered on transparency without subpixel anti-aliasing
+	 */
+	cairo_font_options_t *opts = cairo_font_options_create();
+	cairo_font_options_set_antialias(opts, CAIRO_ANTIALIAS_GRAY);
+	pango_cairo_context_set_font_options(
+		pango_layout_get_context(layout), opts);
+	cairo_font_options_destroy(opts);
+
+	for (int i = 0; i < atlas->nr_glyphs; i++) {
+		int x = i * new_strip.slot_width + new_strip.pad;
+		cairo_move_to(cairo, x / scale, 0);
+		pango_layout_set_text(layout, &atlas->glyphs[i], 1);
+		pango_cairo_update_layout(cairo, layout);
+		pango_cairo_show_layout(cairo, layout);
+	}
+
+	g_object_unref(layout);
+	cairo_destroy(cairo);
+	cairo_surface_flush(new_strip.surface);
+	cairo_surface_set_device_scale(new_strip.surface, 1, 1);
+
+	array_add(&atlas->strips, new_strip);
+	return (struct glyph_strip *)atlas->strips.data
+		+ atlas->strips.size / sizeof(new_strip) - 1;
+}
+
+struct glyph_atlas *
+glyph_atlas_create(const char *glyphs, struct font *font,
+		const float *color, const float *bg_color)
+{
+	assert(glyphs);
+	assert(strlen(glyphs) < UINT8_MAX);
+
+	struct glyph_atlas *atlas = znew(*atlas);
+	atlas->glyphs = xstrdup(glyphs);
+	atlas->nr_glyphs = strlen(glyphs);
+	atlas->advances = znew_n(*atlas->advances, atlas->nr_glyphs);
+	for (int i = 0; i < atlas->nr_glyphs; i++) {
+		atlas->slot[(unsigned char)glyphs[i]] = i + 1;
+	}
+
+	if (font->name) {
+		atlas->font.name = xstrdup(font->name);
+	}
+	atlas->font.size = font->size;
+	atlas->font.slant = font->slant;
+	atlas->font.weight = font->weight;
+	memcpy(atlas->color, color, sizeof(atlas->color));
+	memcpy(atlas->bg_color, bg_color, sizeof(atlas->bg_color));
+	wl_array_init(&atlas->strips);
+
+	measure_glyphs(atlas);
+	return atlas;
+}
+
+void
+glyph_atlas_destroy(struct glyph_atlas *atlas)
+{
+	if (!atlas) {
+		return;
+	}
+	struct glyph_strip *strip;
+	wl_array_for_each(strip, &atlas->strips) {
+		cairo_surface_destroy(strip->surface);
+	}
+	wl_array_release(&atlas->strips);
+	zfree(atlas->font.name);
+	zfree(atlas->advances);
+	zfree(atlas->glyphs);
+	free(atlas);
+}
+
+int
+glyph_atlas_height(struct glyph_atlas *atlas)
+{
+	return atlas->height;
+}
+
+int
+glyph_atlas_text_width(struct glyph_atlas *atlas, const char *text)
+{
+	double width = 0;
+	for (const char *p = text; *p; p++) {
+		uint8_t slot = atlas->slot[(unsigned char)*p];
+		if (slot) {
+			width += atlas->advances[slot - 1];
+		}
+	}
+	return (int)ceil(width);
+}
+
+struct lab_data_buffer *
+glyph_atlas_render(struct glyph_atlas *atlas, const char *text, double scale)
+{
+	if (string_null_or_empty(text)) {
+		return NULL;
+	}
+
+	struct glyph_strip *strip = get_strip(atlas, scale);
+	struct lab_data_buffer *buffer = buffer_create_cairo(
+		glyph_atlas_text_width(atlas, text), atlas->height, scale);
+	if (!buffer) {
+		wlr_log(WLR_ERROR, "Failed to create glyph buffer");
+		return NULL;
+	}
+
+	cairo_t *cairo = buffer->cairo;
+
+	/* See font_buffer_create() */
+	if (atlas->bg_color[3] > 0.999f) {
+		set_cairo_color(cairo, atlas->bg_color);
+		cairo_paint(cairo);
+	}
+
+	/*
+	 * Copy in device pixels and snap each glyph to the pixel grid so that
+	 * the strip is never resampled
+	 */
+	cairo_save(cairo);
+	cairo_scale(cairo, 1 / scale, 1 / scale);
+	double pos = 0;
+	for (const char *p = text; *p; p++) {
+		uint8_t slot = atlas->slot[(unsigned char)*p];
+		if (!slot) {
+			continue;
+		}
+		int x = (int)lround(pos * scale) - strip->pad;
+		cairo_set_source_surface(cairo, strip->surface,
+			x - (slot - 1) * strip->slot_width, 0);
+		cairo_rectangle(cairo, x, 0, strip->slot_width, strip->height);
+		cairo_fill(cairo);
+		pos += atlas->advances[slot - 1];
+	}
+	cairo_restore(cairo);
+
+	cairo_surface_flush(cairo_get_target(cairo));
+	return buffer;
+}
@@ -1,6 +1,8 @@
 // SPDX-License-Identifier: GPL-2.0-only
 
 #include <fnmatch.h>
+#include <string.h>
+#include <strings.h>
 #include "common/match.h"
 
 bool
@@ -8,3 +10,57 @@ match_glob(const char *pattern, const char *string)
 {
 	return fnmatch(pattern, string, FNM_CASEFOLD) == 0;
 }
+
+void
+glob_matcher_init(struct glob_matcher *matcher, const char *pattern)
+{
+	*matcher = (struct glob_matcher){ .pattern = pattern };
+	if (!pattern) {
+		matcher->type = LAB_GLOB_NONE;
+		return;
+	}
+
+	size_t special = strcspn(pattern, "*?[\\");
+	matcher->len = special;
+
+	/*
+	 * strcasecmp() only folds single bytes, so leave multibyte patterns
+	 * to fnmatch() which folds case per character in the current locale
+	 */
+	for (const char *p = pattern; *p; p++) {
+		if ((unsigned char)*p >= 0x80) {
+			matcher->type = LAB_GLOB_FNMATCH;
+			return;
+		}
+	}
+
+	if (!pattern[special]) {
+		matcher->type = LAB_GLOB_LITERAL;
+	} else if (!strcmp(pattern + special, "*")) {
+		matcher->type = special ? LAB_GLOB_PREFIX : LAB_GLOB_ANY;
+	} else {
+		matcher->type = LAB_GLOB_FNMATCH;
+	}
+}
+
+bool
+glob_matcher_match(const struct glob_matcher *matcher, const char *string)
+{
+	if (matcher->type == LAB_GLOB_NONE) {
+		return true;
+	}
+	if (!string) {
+		return false;
+	}
+
+	switch (matcher->type) {
+	case LAB_GLOB_ANY:
+		return true;
+	case LAB_GLOB_LITERAL:
+		return !strcasecmp(matcher->pattern, string);
+	case LAB_GLOB_PREFIX:
+		return !strncasecmp(matcher->pattern, string, matcher->len);
+	default:
+		return match_glob(matcher->pattern, string);
+	}
+}
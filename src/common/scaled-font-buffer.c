@@ -104,3 +104,10 @@ scaled_font_buffer_set_max_width(struct scaled_font_buffer *self, int max_width)
 	self->max_width = max_width;
 	scaled_scene_buffer_invalidate_cache(self->scaled_buffer);
 }
+
+void
+scaled_font_buffer_prerender(struct scaled_font_buffer *self, double scale)
+{
+	assert(self);
+	scaled_scene_buffer_prerender(self->scaled_buffer, scale);
+}
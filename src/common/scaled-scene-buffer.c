@@ -8,6 +8,7 @@
 #include <wlr/types/wlr_scene.h>
 #include <wlr/util/log.h>
 #include "buffer.h"
+#include "common/list.h"
 #include "common/mem.h"
 #include "common/scaled-scene-buffer.h"
 
@@ -202,3 +203,31 @@ scaled_scene_buffer_invalidate_cache(struct scaled_scene_buffer *self)
 	assert(wl_list_empty(&self->cache));
 	_update_buffer(self, self->active_scale);
 }
+
+void
+scaled_scene_buffer_prerender(struct scaled_scene_buffer *self, double scale)
+{
+	assert(self);
+	struct scaled_scene_buffer_cache_entry *cache_entry;
+	wl_list_for_each(cache_entry, &self->cache, link) {
+		if (cache_entry->scale == scale) {
+			return;
+		}
+	}
+	if (wl_list_length(&self->cache) >= LAB_SCALED_BUFFER_MAX_CACHE) {
+		return;
+	}
+
+	struct lab_data_buffer *buffer = self->impl->create_buffer(self, scale);
+	if (!buffer) {
+		return;
+	}
+	/* Ensure the buffer doesn't get deleted behind our back */
+	wlr_buffer_lock(&buffer->base);
+
+	/* Append so that the buffer currently in use stays most recently used */
+	cache_entry = znew(*cache_entry);
+	cache_entry->scale = scale;
+	cache_entry->buffer = &buffer->base;
+	wl_list_append(&self->cache, &cache_entry->link);
+}
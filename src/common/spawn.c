@@ -1,17 +1,36 @@
 // SPDX-License-Identifier: GPL-2.0-only
 #define _POSIX_C_SOURCE 200809L
+/* For vfork() */
+#define _DEFAULT_SOURCE
 #include <assert.h>
+#include <errno.h>
 #include <fcntl.h>
 #include <glib.h>
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/wait.h>
 #include <unistd.h>
+#include <wayland-util.h>
 #include <wlr/util/log.h>
+#include "common/array.h"
 #include "common/spawn.h"
 #include "common/fd-util.h"
 
+/* pid_t of every child not yet reaped, see spawn_reap_child() */
+static struct wl_array children;
+
+static void
+track_child(pid_t pid)
+{
+	array_add(&children, pid);
+}
+
+/*
+ * Runs in the child, which may share our memory (vfork), so this must
+ * only make system calls and not log.
+ */
 static void
 reset_signals_and_limits(void)
 {
@@ -60,33 +79,29 @@ spawn_async_no_shell(char const *command)
 	}
 
 	/*
-	 * Avoid zombie processes by using a double-fork, whereby the
-	 * grandchild becomes orphaned & the responsibility of the OS.
+	 * Use vfork() rather than fork() so that the compositor's page
+	 * tables are not copied, which gets slow with a large RSS. The
+	 * child shares our memory until it calls execvp(), so it must not
+	 * do more than make system calls.
+	 *
+	 * The child is not waited for here but reaped by the SIGCHLD
+	 * handler in src/server.c via spawn_reap_child() once it exits,
+	 * which also logs the exit status 127 of a failing execvp().
 	 */
-	pid_t child = 0, grandchild = 0;
-
-	child = fork();
+	pid_t child = vfork();
 	switch (child) {
 	case -1:
-		wlr_log(WLR_ERROR, "unable to fork()");
-		goto out;
+		wlr_log_errno(WLR_ERROR, "unable to vfork()");
+		break;
 	case 0:
 		reset_signals_and_limits();
-
 		setsid();
-		grandchild = fork();
-		if (grandchild == 0) {
-			execvp(argv[0], argv);
-			_exit(0);
-		} else if (grandchild < 0) {
-			wlr_log(WLR_ERROR, "unable to fork()");
-		}
-		_exit(0);
+		execvp(argv[0], argv);
+		_exit(127);
 	default:
+		track_child(child);
 		break;
 	}
-	waitpid(child, NULL, 0);
-out:
 	g_strfreev(argv);
 }
 
@@ -120,6 +135,7 @@ spawn_primary_client(const char *command)
 		wlr_log_errno(WLR_ERROR, "Failed to execute primary client %s", command);
 		_exit(1);
 	default:
+		track_child(child);
 		g_strfreev(argv);
 		return child;
 	}
@@ -180,6 +196,7 @@ spawn_piped(const char *command, int *pipe_fd)
 	}
 
 	/* labwc */
+	track_child(pid);
 	close(pipe_rw[1]);
 
 	/*
@@ -196,5 +213,61 @@ void
 spawn_piped_close(pid_t pid, int pipe_fd)
 {
 	close(pipe_fd);
-	/* waitpid() is done in a generic SIGCHLD handler in src/server.c */
+	/* waitpid() is done by spawn_reap_child() on SIGCHLD */
+}
+
+static void
+log_child_exit(const siginfo_t *info)
+{
+	switch (info->si_code) {
+	case CLD_EXITED:
+		/* 127 is what spawn_async_no_shell() uses for exec failures */
+		wlr_log(info->si_status == 127 ? WLR_ERROR : WLR_DEBUG,
+			"spawned child %ld exited with %d",
+			(long)info->si_pid, info->si_status);
+		break;
+	case CLD_KILLED:
+	case CLD_DUMPED:
+		; /* works around "a label can only be part of a statement" */
+		const char *signame = strsignal(info->si_status);
+		wlr_log(WLR_DEBUG,
+			"spawned child %ld terminated with signal %d (%s)",
+			(long)info->si_pid, info->si_status,
+			signame ? signame : "unknown");
+		break;
+	default:
+		wlr_log(WLR_ERROR,
+			"spawned child %ld terminated unexpectedly: %d"
+			" please report", (long)info->si_pid, info->si_code);
+	}
+}
+
+pid_t
+spawn_reap_child(void)
+{
+	/*
+	 * Only wait for our own children by pid. Waiting for any child
+	 * would also see Xwayland, which wlroots reaps itself.
+	 */
+	pid_t *pids = children.data;
+	size_t count = children.size / sizeof(*pids);
+	for (size_t i = 0; i < count; i++) {
+		pid_t pid = pids[i];
+		siginfo_t info = { 0 };
+		if (waitid(P_PID, pid, &info, WEXITED | WNOHANG) == -1) {
+			if (errno != ECHILD) {
+				continue;
+			}
+			/* Already reaped elsewhere, just forget about it */
+		} else if (info.si_pid == 0) {
+			/* Still running */
+			continue;
+		} else {
+			log_child_exit(&info);
+		}
+		pids[i] = pids[count - 1];
+		children.size -= sizeof(*pids);
+		return pid;
+	}
+	return 0;
 }
@@ -1085,6 +1085,8 @@ entry(xmlNode *node, char *nodename, char *content)
 		}
 	} else if (!strcasecmp(nodename, "xwaylandPersistence.core")) {
 		set_bool(content, &rc.xwayland_persistence);
+	} else if (!strcasecmp(nodename, "xwaylandPrewarmDelay.core")) {
+		rc.xwayland_prewarm_delay = MAX(atoi(content), 0);
 	} else if (!strcasecmp(nodename, "x.cascadeOffset.placement")) {
 		rc.placement_cascade_offset_x = atoi(content);
 	} else if (!strcasecmp(nodename, "y.cascadeOffset.placement")) {
@@ -1093,6 +1095,8 @@ entry(xmlNode *node, char *nodename, char *content)
 		rc.theme_name = xstrdup(content);
 	} else if (!strcmp(nodename, "icon.theme")) {
 		rc.icon_theme_name = xstrdup(content);
+	} else if (!strcasecmp(nodename, "iconCacheSize.theme")) {
+		rc.icon_cache_size = MAX(atoi(content), 0);
 	} else if (!strcasecmp(nodename, "layout.titlebar.theme")) {
 		fill_title_layout(content);
 	} else if (!strcasecmp(nodename, "showTitle.titlebar.theme")) {
@@ -1444,12 +1448,14 @@ rcxml_init(void)
 	rc.ssd_keep_border = true;
 	rc.corner_radius = 8;
 	rc.shadows_enabled = false;
+	rc.icon_cache_size = 4096;
 
 	rc.gap = 0;
 	rc.adaptive_sync = LAB_ADAPTIVE_SYNC_DISABLED;
 	rc.allow_tearing = false;
 	rc.reuse_output_mode = false;
 	rc.xwayland_persistence = false;
+	rc.xwayland_prewarm_delay = 0;
 
 	init_font_defaults(&rc.font_activewindow);
 	init_font_defaults(&rc.font_inactivewindow);
@@ -1851,11 +1857,20 @@ validate(void)
 	}
 }
 
-void
-rcxml_read(const char *filename)
-{
-	rcxml_init();
+/*
+ * Contents of the config files parsed by the last rcxml_read(), used to
+ * detect whether they need to be parsed again on Reconfigure.
+ */
+static struct buf last_config = { .data = "" };
 
+/*
+ * Read the config files which rcxml_read() parses and call @handler for
+ * each of them, in the order they are to be parsed.
+ */
+static void
+read_config_files(const char *filename,
+		void (*handler)(const char *path, struct buf *content))
+{
 	struct wl_list paths;
 
 	if (filename) {
@@ -1890,8 +1905,6 @@ rcxml_read(const char *filename)
 			continue;
 		}
 
-		wlr_log(WLR_INFO, "read config file %s", path->string);
-
 		struct buf b = BUF_INIT;
 		char *line = NULL;
 		size_t len = 0;
@@ -1904,20 +1917,58 @@ rcxml_read(const char *filename)
 		}
 		zfree(line);
 		fclose(stream);
-		rcxml_parse_xml(&b);
+		handler(path->string, &b);
 		buf_reset(&b);
 		if (!should_merge_config) {
 			break;
 		}
 	};
 	paths_destroy(&paths);
+}
+
+static struct buf *current_config;
+
+static void
+record_config_file(const char *path, struct buf *content)
+{
+	buf_add_fmt(current_config, "%s\n%s\n", path, content->data);
+}
+
+static void
+parse_config_file(const char *path, struct buf *content)
+{
+	wlr_log(WLR_INFO, "read config file %s", path);
+	current_config = &last_config;
+	record_config_file(path, content);
+	rcxml_parse_xml(content);
+}
+
+void
+rcxml_read(const char *filename)
+{
+	rcxml_init();
+	buf_clear(&last_config);
+	read_config_files(filename, parse_config_file);
 	post_processing();
 	validate();
+	window_rules_init();
+}
+
+bool
+rcxml_config_changed(const char *filename)
+{
+	struct buf config = BUF_INIT;
+	current_config = &config;
+	read_config_files(filename, record_config_file);
+	bool changed = strcmp(config.data, last_config.data);
+	buf_reset(&config);
+	return changed;
 }
 
 void
 rcxml_finish(void)
 {
+	buf_reset(&last_config);
 	zfree(rc.font_activewindow.name);
 	zfree(rc.font_inactivewindow.name);
 	zfree(rc.font_menuheader.name);
@@ -1991,6 +2042,7 @@ rcxml_finish(void)
 		osd_field_free(field);
 	}
 
+	window_rules_finish();
 	struct window_rule *rule, *rule_tmp;
 	wl_list_for_each_safe(rule, rule_tmp, &rc.window_rules, link) {
 		rule_destroy(rule);
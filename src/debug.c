@@ -3,7 +3,11 @@
 #include <wlr/types/wlr_scene.h>
 #include "common/graphic-helpers.h"
 #include "common/scene-helpers.h"
+#include "config.h"
 #include "debug.h"
+#if HAVE_LIBSFDO
+#include "icon-loader.h"
+#endif
 #include "input/ime.h"
 #include "labwc.h"
 #include "node.h"
@@ -257,6 +261,13 @@ debug_dump_scene(struct server *server)
 	dump_tree(server, &server->scene->tree.node, 0, 0, 0);
 	printf("\n");
 
+#if HAVE_LIBSFDO
+	struct icon_cache_stats stats;
+	icon_loader_get_cache_stats(server, &stats);
+	printf("icon cache: %d entries, %zu KiB, %u hits, %u misses\n\n",
+		stats.entries, stats.bytes / 1024, stats.hits, stats.misses);
+#endif
+
 	/*
 	 * Reset last_view so we don't access a
 	 * potentially free'd pointer on the next call
@@ -3,7 +3,6 @@
 #include <assert.h>
 #include "common/scene-helpers.h"
 #include "common/surface-helpers.h"
-#include "dnd.h"
 #include "labwc.h"
 #include "layers.h"
 #include "node.h"
@@ -266,25 +265,144 @@ get_surface_from_layer_node(struct wlr_scene_node *node)
 	return NULL;
 }
 
-/* TODO: make this less big and scary */
-struct cursor_context
-get_cursor_context(struct server *server)
+struct buffer_hit_data {
+	double lx, ly;
+	bool hit;
+};
+
+static void
+buffer_hit_iterator(struct wlr_scene_buffer *buffer, int lx, int ly,
+		void *user_data)
 {
-	struct cursor_context ret = {.type = LAB_SSD_NONE};
-	struct wlr_cursor *cursor = server->seat.cursor;
+	struct buffer_hit_data *data = user_data;
+	struct wlr_box box = {
+		.x = lx,
+		.y = ly,
+		.width = buffer->dst_width,
+		.height = buffer->dst_height,
+	};
+	/* Be conservative with buffers without explicit destination size */
+	if (wlr_box_empty(&box) || wlr_box_contains_point(&box,
+			data->lx, data->ly)) {
+		data->hit = true;
+	}
+}
+
+/*
+ * Coarse hit-test which returns false if none of the nodes belonging to
+ * @view can possibly be at layout coordinates (lx, ly). This allows
+ * skipping the scene walk through all the SSD parts of views which are
+ * nowhere near the cursor.
+ */
+static bool
+view_may_contain_point(struct view *view, double lx, double ly)
+{
+	/* Resize outlines and indicator may exceed the view geometry */
+	if (view == view->server->grabbed_view) {
+		return true;
+	}
+
+	/* Titlebar, border and invisible resize extents */
+	struct wlr_box box = ssd_max_extents(view);
+	if (view->ssd_enabled) {
+		box.x -= SSD_EXTENDED_AREA;
+		box.y -= SSD_EXTENDED_AREA;
+		box.width += 2 * SSD_EXTENDED_AREA;
+		box.height += 2 * SSD_EXTENDED_AREA;
+	}
+	if (wlr_box_contains_point(&box, lx, ly)) {
+		return true;
+	}
+
+	/*
+	 * Client surfaces (including subsurfaces and CSD shadows) may extend
+	 * beyond the view geometry, so check their actual buffers.
+	 */
+	if (!view->scene_node) {
+		return false;
+	}
+	struct buffer_hit_data data = { .lx = lx, .ly = ly };
+	int parent_lx, parent_ly;
+	wlr_scene_node_coords(&view->scene_tree->node, &parent_lx, &parent_ly);
+	data.lx -= parent_lx;
+	data.ly -= parent_ly;
+	wlr_scene_node_for_each_buffer(view->scene_node,
+		buffer_hit_iterator, &data);
+	return data.hit;
+}
+
+/* Trees whose children are views (or other trees holding views) */
+static bool
+is_view_container(struct server *server, struct wlr_scene_node *node)
+{
+	if (node->type != WLR_SCENE_NODE_TREE) {
+		return false;
+	}
+	return node == &server->scene->tree.node
+		|| node == &server->view_tree->node
+		|| node == &server->view_tree_always_on_top->node
+		|| node == &server->view_tree_always_on_bottom->node
+		/* workspace trees */
+		|| node->parent == server->view_tree;
+}
 
+/*
+ * Trees which are skipped by hit-testing without changing their enabled
+ * state, which would otherwise damage their area on every motion event.
+ */
+static bool
+is_non_input_tree(struct server *server, struct wlr_scene_node *node)
+{
 	/* Prevent drag icons to be on top of the hitbox detection */
-	if (server->seat.drag.active) {
-		dnd_icons_show(&server->seat, false);
+	return node == &server->seat.drag.icons->node;
+}
+
+/*
+ * Like wlr_scene_node_at() but first walks the top-level trees in stacking
+ * order and only descends into the subtrees of views that pass the coarse
+ * hit-test above.
+ */
+static struct wlr_scene_node *
+node_at(struct server *server, struct wlr_scene_node *node,
+		double lx, double ly, double *sx, double *sy)
+{
+	if (!node->enabled || is_non_input_tree(server, node)) {
+		return NULL;
 	}
 
-	struct wlr_scene_node *node =
-		wlr_scene_node_at(&server->scene->tree.node,
-			cursor->x, cursor->y, &ret.sx, &ret.sy);
+	struct node_descriptor *desc = node->data;
+	if (desc && desc->type == LAB_NODE_DESC_VIEW) {
+		if (!view_may_contain_point(desc->data, lx, ly)) {
+			return NULL;
+		}
+		return wlr_scene_node_at(node, lx, ly, sx, sy);
+	}
 
-	if (server->seat.drag.active) {
-		dnd_icons_show(&server->seat, true);
+	if (!is_view_container(server, node)) {
+		return wlr_scene_node_at(node, lx, ly, sx, sy);
+	}
+
+	struct wlr_scene_tree *tree = wlr_scene_tree_from_node(node);
+	struct wlr_scene_node *child;
+	wl_list_for_each_reverse(child, &tree->children, link) {
+		struct wlr_scene_node *found =
+			node_at(server, child, lx, ly, sx, sy);
+		if (found) {
+			return found;
+		}
 	}
+	return NULL;
+}
+
+/* TODO: make this less big and scary */
+struct cursor_context
+get_cursor_context(struct server *server)
+{
+	struct cursor_context ret = {.type = LAB_SSD_NONE};
+	struct wlr_cursor *cursor = server->seat.cursor;
+
+	struct wlr_scene_node *node = node_at(server, &server->scene->tree.node,
+		cursor->x, cursor->y, &ret.sx, &ret.sy);
 
 	ret.node = node;
 	if (!node) {
@@ -1,10 +1,24 @@
 // SPDX-License-Identifier: GPL-2.0-only
+#define _POSIX_C_SOURCE 200809L
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <glib.h>
+#include <pthread.h>
 #include <sfdo-desktop.h>
 #include <sfdo-icon.h>
 #include <sfdo-basedir.h>
+#include <signal.h>
 #include <string.h>
 #include <strings.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <wayland-server-core.h>
 #include <wlr/util/log.h>
+#include "buffer.h"
+#include "common/file-helpers.h"
 #include "common/macros.h"
 #include "common/mem.h"
 #include "common/string-helpers.h"
@@ -19,13 +33,109 @@
 
 #include "labwc.h"
 
+#define ICON_INDEX_VERSION 1
+
 struct icon_loader {
+	struct sfdo_basedir_ctx *basedir_ctx;
 	struct sfdo_desktop_ctx *desktop_ctx;
 	struct sfdo_icon_ctx *icon_ctx;
+	char *icon_theme_name;
+
+	/*
+	 * Scanning all XDG data dirs and the icon theme can take a while,
+	 * so the databases are only loaded by the worker thread once an
+	 * icon is not found in the on-disk index.
+	 */
+	bool databases_loaded;
 	struct sfdo_desktop_db *desktop_db;
 	struct sfdo_icon_theme *icon_theme;
+
+	/*
+	 * Lowercased desktop ID base (the part after the last '.') and
+	 * StartupWMClass mapped to the index of the first desktop entry
+	 * having it, plus one. Used by get_db_entry_by_id_fuzzy().
+	 */
+	struct {
+		GHashTable *by_id_base;
+		GHashTable *by_wm_class;
+	} fuzzy;
+
+	/*
+	 * Resolved icon paths keyed by "app_id<TAB>size<TAB>scale", saved to
+	 * $XDG_CACHE_HOME/labwc/icon-index. An empty path records that no
+	 * icon was found. The file is discarded when the modification times
+	 * of the application and icon dirs change.
+	 *
+	 * index_path and the stamps are computed on the compositor thread,
+	 * which may change the environment at any time. The index itself
+	 * is written back when the worker thread runs out of requests.
+	 */
+	GHashTable *index;
+	bool index_dirty;
+	char *index_path;
+	uint64_t index_stamp;
+
+	/*
+	 * Lookups and decoding run on a single worker thread, which is the
+	 * only user of the sfdo objects above once initialization is done.
+	 * Completed requests are handed back to the compositor thread via
+	 * event_fd.
+	 */
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	int event_fd;
+	struct wl_event_source *event_source;
+
+	/* Protected by lock */
+	struct wl_list queued; /* struct icon_request.link */
+	struct wl_list done; /* struct icon_request.link */
+	bool reload;
+	uint64_t reload_stamp;
+	bool quit;
+
+	/* Decoded icons; only accessed on the compositor thread */
+	struct {
+		struct wl_list entries; /* most recently used first */
+		size_t bytes;
+		unsigned int hits;
+		unsigned int misses;
+	} cache;
 };
 
+struct icon_cache_entry {
+	char *app_id;
+	char *path;
+	int size;
+	float scale;
+	struct lab_data_buffer *buffer;
+	size_t bytes;
+	struct wl_list link; /* icon_loader.cache.entries */
+};
+
+struct icon_request {
+	/* Immutable after creation */
+	char *app_id;
+	int size;
+	float scale;
+	void (*callback)(struct lab_data_buffer *buffer, void *data);
+	void *data;
+
+	/* Written by the worker thread before the request is done */
+	struct lab_data_buffer *buffer;
+	char *path;
+
+	/* Protected by icon_loader.lock */
+	bool cancelled;
+	struct wl_list link;
+};
+
+static struct lab_data_buffer *lookup_icon(struct icon_loader *loader,
+	const char *app_id, int size, float scale, char **path);
+static void index_save(struct icon_loader *loader);
+static uint64_t get_index_stamp(struct icon_loader *loader);
+static char *get_index_path(void);
+
 static void
 log_handler(enum sfdo_log_level level, const char *fmt, va_list args, void *tag)
 {
@@ -39,20 +149,282 @@ log_handler(enum sfdo_log_level level, const char *fmt, va_list args, void *tag)
 	_wlr_vlog((enum wlr_log_importance)level, fmt, args);
 }
 
+static void
+cache_remove(struct icon_loader *loader, struct icon_cache_entry *entry)
+{
+	loader->cache.bytes -= entry->bytes;
+	wl_list_remove(&entry->link);
+	wlr_buffer_unlock(&entry->buffer->base);
+	free(entry->app_id);
+	free(entry->path);
+	free(entry);
+}
+
+static struct icon_cache_entry *
+cache_find(struct icon_loader *loader, const char *app_id, const char *path,
+		int size, float scale)
+{
+	struct icon_cache_entry *entry;
+	wl_list_for_each(entry, &loader->cache.entries, link) {
+		if (entry->size != size || entry->scale != scale) {
+			continue;
+		}
+		if ((app_id && !strcmp(entry->app_id, app_id))
+				|| (path && !strcmp(entry->path, path))) {
+			return entry;
+		}
+	}
+	return NULL;
+}
+
+/*
+ * Add the icon of a completed request to the cache. If another app_id
+ * already resolved to the same icon file, the decoded buffer is shared
+ * and the request's own copy is dropped.
+ */
+static void
+cache_add(struct icon_loader *loader, struct icon_request *request)
+{
+	size_t budget = (size_t)rc.icon_cache_size * 1024;
+	if (!budget) {
+		return;
+	}
+
+	struct icon_cache_entry *other = cache_find(loader, NULL,
+		request->path, request->size, request->scale);
+	if (other) {
+		wlr_buffer_unlock(&request->buffer->base);
+		request->buffer = other->buffer;
+		wlr_buffer_lock(&request->buffer->base);
+	}
+
+	struct icon_cache_entry *entry = znew(*entry);
+	entry->app_id = xstrdup(request->app_id);
+	entry->path = xstrdup(request->path);
+	entry->size = request->size;
+	entry->scale = request->scale;
+	entry->buffer = request->buffer;
+	wlr_buffer_lock(&entry->buffer->base);
+	/* Shared buffers are charged to every entry, erring towards eviction */
+	entry->bytes = entry->buffer->stride * entry->buffer->base.height;
+	wl_list_insert(&loader->cache.entries, &entry->link);
+	loader->cache.bytes += entry->bytes;
+
+	while (loader->cache.bytes > budget) {
+		struct icon_cache_entry *lru = wl_container_of(
+			loader->cache.entries.prev, lru, link);
+		cache_remove(loader, lru);
+	}
+}
+
+static void
+complete_request(struct icon_loader *loader, struct icon_request *request)
+{
+	if (request->buffer) {
+		/* Hold a lock rather than ownership so it can be shared */
+		wlr_buffer_lock(&request->buffer->base);
+		wlr_buffer_drop(&request->buffer->base);
+		cache_add(loader, request);
+	}
+	if (!request->cancelled) {
+		request->callback(request->buffer, request->data);
+	}
+	if (request->buffer) {
+		wlr_buffer_unlock(&request->buffer->base);
+	}
+	free(request->app_id);
+	free(request->path);
+	free(request);
+}
+
+static int
+handle_event_fd(int fd, uint32_t mask, void *data)
+{
+	struct icon_loader *loader = data;
+
+	uint64_t count;
+	if (read(fd, &count, sizeof(count)) < 0) {
+		wlr_log_errno(WLR_DEBUG, "failed to read icon loader eventfd");
+	}
+
+	struct wl_list done;
+	pthread_mutex_lock(&loader->lock);
+	wl_list_init(&done);
+	wl_list_insert_list(&done, &loader->done);
+	wl_list_init(&loader->done);
+	pthread_mutex_unlock(&loader->lock);
+
+	struct icon_request *request, *tmp;
+	wl_list_for_each_safe(request, tmp, &done, link) {
+		wl_list_remove(&request->link);
+		complete_request(loader, request);
+	}
+	return 0;
+}
+
+/*
+ * Runs on the worker thread, or after it has been stopped. The databases
+ * and the on-disk index are loaded again on the next lookup.
+ */
+static void
+unload_databases(struct icon_loader *loader)
+{
+	if (loader->index) {
+		if (loader->index_dirty) {
+			index_save(loader);
+		}
+		g_hash_table_destroy(loader->index);
+		loader->index = NULL;
+	}
+	if (loader->icon_theme) {
+		sfdo_icon_theme_destroy(loader->icon_theme);
+		loader->icon_theme = NULL;
+	}
+	if (loader->desktop_db) {
+		g_hash_table_destroy(loader->fuzzy.by_id_base);
+		g_hash_table_destroy(loader->fuzzy.by_wm_class);
+		sfdo_desktop_db_destroy(loader->desktop_db);
+		loader->desktop_db = NULL;
+	}
+	loader->databases_loaded = false;
+}
+
+static void *
+worker_run(void *data)
+{
+	struct icon_loader *loader = data;
+
+	pthread_mutex_lock(&loader->lock);
+	while (!loader->quit) {
+		if (wl_list_empty(&loader->queued)) {
+			if (loader->index_dirty) {
+				/* Write new entries once we are idle */
+				pthread_mutex_unlock(&loader->lock);
+				index_save(loader);
+				pthread_mutex_lock(&loader->lock);
+				continue;
+			}
+			pthread_cond_wait(&loader->cond, &loader->lock);
+			continue;
+		}
+		struct icon_request *request =
+			wl_container_of(loader->queued.prev, request, link);
+		wl_list_remove(&request->link);
+
+		if (!request->cancelled) {
+			bool reload = loader->reload;
+			uint64_t reload_stamp = loader->reload_stamp;
+			loader->reload = false;
+			pthread_mutex_unlock(&loader->lock);
+			if (reload) {
+				unload_databases(loader);
+				loader->index_stamp = reload_stamp;
+			}
+			request->buffer = lookup_icon(loader, request->app_id,
+				request->size, request->scale, &request->path);
+			pthread_mutex_lock(&loader->lock);
+		}
+
+		wl_list_insert(loader->done.prev, &request->link);
+		uint64_t one = 1;
+		if (write(loader->event_fd, &one, sizeof(one)) < 0) {
+			wlr_log_errno(WLR_ERROR, "failed to signal icon loaded");
+		}
+	}
+	pthread_mutex_unlock(&loader->lock);
+
+	if (loader->index_dirty) {
+		index_save(loader);
+	}
+	return NULL;
+}
+
+/* Return 0 on success and -1 on error */
+static int
+start_worker(struct icon_loader *loader, struct wl_event_loop *event_loop)
+{
+	wl_list_init(&loader->queued);
+	wl_list_init(&loader->done);
+	wl_list_init(&loader->cache.entries);
+
+	loader->event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (loader->event_fd < 0) {
+		wlr_log_errno(WLR_ERROR, "failed to create eventfd");
+		return -1;
+	}
+	loader->event_source = wl_event_loop_add_fd(event_loop,
+		loader->event_fd, WL_EVENT_READABLE, handle_event_fd, loader);
+	if (!loader->event_source) {
+		goto err_event_source;
+	}
+
+	pthread_mutex_init(&loader->lock, NULL);
+	pthread_cond_init(&loader->cond, NULL);
+
+	/* Leave signal handling to the compositor thread */
+	sigset_t all, old;
+	sigfillset(&all);
+	pthread_sigmask(SIG_SETMASK, &all, &old);
+	int ret = pthread_create(&loader->thread, NULL, worker_run, loader);
+	pthread_sigmask(SIG_SETMASK, &old, NULL);
+	if (ret) {
+		wlr_log(WLR_ERROR, "failed to start icon loader thread");
+		goto err_thread;
+	}
+	return 0;
+
+err_thread:
+	pthread_cond_destroy(&loader->cond);
+	pthread_mutex_destroy(&loader->lock);
+	wl_event_source_remove(loader->event_source);
+err_event_source:
+	close(loader->event_fd);
+	return -1;
+}
+
+static void
+stop_worker(struct icon_loader *loader)
+{
+	pthread_mutex_lock(&loader->lock);
+	loader->quit = true;
+	pthread_cond_signal(&loader->cond);
+	pthread_mutex_unlock(&loader->lock);
+	pthread_join(loader->thread, NULL);
+
+	/*
+	 * Complete outstanding requests (unfinished ones without an icon)
+	 * so that nobody is left holding a pointer to them.
+	 */
+	struct icon_request *request, *tmp;
+	wl_list_for_each_safe(request, tmp, &loader->done, link) {
+		wl_list_remove(&request->link);
+		complete_request(loader, request);
+	}
+	wl_list_for_each_safe(request, tmp, &loader->queued, link) {
+		wl_list_remove(&request->link);
+		complete_request(loader, request);
+	}
+
+	wl_event_source_remove(loader->event_source);
+	close(loader->event_fd);
+	pthread_cond_destroy(&loader->cond);
+	pthread_mutex_destroy(&loader->lock);
+}
+
 void
 icon_loader_init(struct server *server)
 {
 	struct icon_loader *loader = znew(*loader);
 
-	struct sfdo_basedir_ctx *basedir_ctx = sfdo_basedir_ctx_create();
-	if (!basedir_ctx) {
+	loader->basedir_ctx = sfdo_basedir_ctx_create();
+	if (!loader->basedir_ctx) {
 		goto err_basedir_ctx;
 	}
-	loader->desktop_ctx = sfdo_desktop_ctx_create(basedir_ctx);
+	loader->desktop_ctx = sfdo_desktop_ctx_create(loader->basedir_ctx);
 	if (!loader->desktop_ctx) {
 		goto err_desktop_ctx;
 	}
-	loader->icon_ctx = sfdo_icon_ctx_create(basedir_ctx);
+	loader->icon_ctx = sfdo_icon_ctx_create(loader->basedir_ctx);
 	if (!loader->icon_ctx) {
 		goto err_icon_ctx;
 	}
@@ -65,10 +437,143 @@ icon_loader_init(struct server *server)
 	sfdo_icon_ctx_set_log_handler(
 		loader->icon_ctx, level, log_handler, "sfdo-icon");
 
+	/* rc may be re-read while the worker thread is running */
+	if (rc.icon_theme_name) {
+		loader->icon_theme_name = xstrdup(rc.icon_theme_name);
+	}
+
+	/* getenv() is not safe while the main thread may call setenv() */
+	loader->index_path = get_index_path();
+	loader->index_stamp = get_index_stamp(loader);
+
+	if (start_worker(loader, server->wl_event_loop) < 0) {
+		goto err_worker;
+	}
+
+	server->icon_loader = loader;
+	return;
+
+err_worker:
+	free(loader->index_path);
+	free(loader->icon_theme_name);
+	sfdo_icon_ctx_destroy(loader->icon_ctx);
+err_icon_ctx:
+	sfdo_desktop_ctx_destroy(loader->desktop_ctx);
+err_desktop_ctx:
+	sfdo_basedir_ctx_destroy(loader->basedir_ctx);
+err_basedir_ctx:
+	free(loader);
+	wlr_log(WLR_ERROR, "Failed to initialize icon loader");
+}
+
+void
+icon_loader_finish(struct server *server)
+{
+	struct icon_loader *loader = server->icon_loader;
+	if (!loader) {
+		return;
+	}
+	server->icon_loader = NULL;
+
+	stop_worker(loader);
+
+	struct icon_cache_entry *entry, *tmp;
+	wl_list_for_each_safe(entry, tmp, &loader->cache.entries, link) {
+		cache_remove(loader, entry);
+	}
+
+	unload_databases(loader);
+	free(loader->index_path);
+	free(loader->icon_theme_name);
+	sfdo_icon_ctx_destroy(loader->icon_ctx);
+	sfdo_desktop_ctx_destroy(loader->desktop_ctx);
+	sfdo_basedir_ctx_destroy(loader->basedir_ctx);
+	free(loader);
+}
+
+bool
+icon_loader_reload(struct server *server)
+{
+	struct icon_loader *loader = server->icon_loader;
+	if (!loader || g_strcmp0(loader->icon_theme_name, rc.icon_theme_name)) {
+		icon_loader_finish(server);
+		icon_loader_init(server);
+		return true;
+	}
+
+	/*
+	 * Keep the worker thread and the decoded icons, but make the worker
+	 * pick up added or removed desktop entries and icons before its
+	 * next lookup.
+	 */
+	uint64_t stamp = get_index_stamp(loader);
+	pthread_mutex_lock(&loader->lock);
+	loader->reload = true;
+	loader->reload_stamp = stamp;
+	pthread_mutex_unlock(&loader->lock);
+	return false;
+}
+
+static void
+fuzzy_index_add(GHashTable *table, const char *key, size_t entry_index)
+{
+	char *lowercase_key = g_ascii_strdown(key, -1);
+	if (g_hash_table_contains(table, lowercase_key)) {
+		/* The first entry wins, as with a linear search */
+		g_free(lowercase_key);
+		return;
+	}
+	g_hash_table_insert(table, lowercase_key,
+		GSIZE_TO_POINTER(entry_index + 1));
+}
+
+static void
+build_fuzzy_index(struct icon_loader *loader)
+{
+	loader->fuzzy.by_id_base = g_hash_table_new_full(g_str_hash,
+		g_str_equal, g_free, NULL);
+	loader->fuzzy.by_wm_class = g_hash_table_new_full(g_str_hash,
+		g_str_equal, g_free, NULL);
+
+	size_t n_entries;
+	struct sfdo_desktop_entry **entries =
+		sfdo_desktop_db_get_entries(loader->desktop_db, &n_entries);
+
+	for (size_t i = 0; i < n_entries; i++) {
+		struct sfdo_desktop_entry *entry = entries[i];
+		const char *desktop_id = sfdo_desktop_entry_get_id(entry, NULL);
+		/* Get portion of desktop ID after last '.' */
+		const char *dot = strrchr(desktop_id, '.');
+		const char *desktop_id_base = dot ? (dot + 1) : desktop_id;
+		fuzzy_index_add(loader->fuzzy.by_id_base, desktop_id_base, i);
+
+		/* sfdo_desktop_entry_get_startup_wm_class() asserts against APPLICATION */
+		if (sfdo_desktop_entry_get_type(entry) != SFDO_DESKTOP_ENTRY_APPLICATION) {
+			continue;
+		}
+		const char *wm_class =
+			sfdo_desktop_entry_get_startup_wm_class(entry, NULL);
+		if (wm_class) {
+			fuzzy_index_add(loader->fuzzy.by_wm_class, wm_class, i);
+		}
+	}
+}
+
+/* Runs on the worker thread; returns false if loading failed */
+static bool
+load_databases(struct icon_loader *loader)
+{
+	if (loader->databases_loaded) {
+		return loader->desktop_db && loader->icon_theme;
+	}
+	loader->databases_loaded = true;
+
 	loader->desktop_db = sfdo_desktop_db_load(loader->desktop_ctx, NULL);
 	if (!loader->desktop_db) {
-		goto err_desktop_db;
+		wlr_log(WLR_ERROR, "Failed to load desktop entries");
+		return false;
 	}
+	build_fuzzy_index(loader);
 
 	/*
 	 * We set some relaxed load options to accommodate delinquent themes in
@@ -85,43 +590,200 @@ icon_loader_init(struct server *server)
 		| SFDO_ICON_THEME_LOAD_OPTION_RELAXED;
 
 	loader->icon_theme = sfdo_icon_theme_load(loader->icon_ctx,
-		rc.icon_theme_name, load_options);
+		loader->icon_theme_name, load_options);
 	if (!loader->icon_theme) {
-		goto err_icon_theme;
+		wlr_log(WLR_ERROR, "Failed to load icon theme");
+		return false;
 	}
+	return true;
+}
 
-	/* basedir_ctx is not referenced by other objects */
-	sfdo_basedir_ctx_destroy(basedir_ctx);
+static void
+stamp_add(uint64_t *stamp, const void *data, size_t len)
+{
+	/* FNV-1a */
+	const unsigned char *bytes = data;
+	for (size_t i = 0; i < len; i++) {
+		*stamp = (*stamp ^ bytes[i]) * 1099511628211ULL;
+	}
+}
 
-	server->icon_loader = loader;
-	return;
+static void
+stamp_add_dir(uint64_t *stamp, const char *dir, const char *subdir)
+{
+	char path[4096];
+	snprintf(path, sizeof(path), "%s%s", dir, subdir);
 
-err_icon_theme:
-	sfdo_desktop_db_destroy(loader->desktop_db);
-err_desktop_db:
-	sfdo_icon_ctx_destroy(loader->icon_ctx);
-err_icon_ctx:
-	sfdo_desktop_ctx_destroy(loader->desktop_ctx);
-err_desktop_ctx:
-	sfdo_basedir_ctx_destroy(basedir_ctx);
-err_basedir_ctx:
-	free(loader);
-	wlr_log(WLR_ERROR, "Failed to initialize icon loader");
+	/* Missing dirs are included too, in case they get created */
+	struct stat st = {0};
+	stat(path, &st);
+	int64_t times[] = { st.st_mtim.tv_sec, st.st_mtim.tv_nsec };
+	stamp_add(stamp, times, sizeof(times));
 }
 
-void
-icon_loader_finish(struct server *server)
+/*
+ * Directory mtimes change when .desktop files or icon themes are added
+ * or removed. Icons added to existing theme subdirs are not detected,
+ * but paths in the index are still checked for existence before use.
+ * Runs on the compositor thread.
+ */
+static uint64_t
+get_index_stamp(struct icon_loader *loader)
 {
-	struct icon_loader *loader = server->icon_loader;
-	if (!loader) {
+	uint64_t stamp = 14695981039346656037ULL;
+
+	size_t n_dirs;
+	const struct sfdo_string *dirs =
+		sfdo_basedir_get_data_dirs(loader->basedir_ctx, &n_dirs);
+	for (size_t i = 0; i < n_dirs; i++) {
+		stamp_add_dir(&stamp, dirs[i].data, "applications");
+		stamp_add_dir(&stamp, dirs[i].data, "icons");
+	}
+	const char *home = getenv("HOME");
+	if (home) {
+		stamp_add_dir(&stamp, home, "/.icons");
+	}
+	stamp_add_dir(&stamp, "/usr/share/pixmaps", "");
+
+	if (loader->icon_theme_name) {
+		stamp_add(&stamp, loader->icon_theme_name,
+			strlen(loader->icon_theme_name));
+	}
+	return stamp;
+}
+
+static char *
+get_index_path(void)
+{
+	const char *cache_home = getenv("XDG_CACHE_HOME");
+	if (!string_null_or_empty(cache_home)) {
+		return strdup_printf("%s/labwc/icon-index", cache_home);
+	}
+	const char *home = getenv("HOME");
+	if (!string_null_or_empty(home)) {
+		return strdup_printf("%s/.cache/labwc/icon-index", home);
+	}
+	return NULL;
+}
+
+static void
+index_parse(struct icon_loader *loader, const char *data, size_t size)
+{
+	const char *end = data + size;
+	const char *eol = memchr(data, '\n', size);
+	if (!eol) {
 		return;
 	}
 
-	sfdo_desktop_db_destroy(loader->desktop_db);
-	sfdo_icon_ctx_destroy(loader->icon_ctx);
-	sfdo_desktop_ctx_destroy(loader->desktop_ctx);
-	free(loader);
-	server->icon_loader = NULL;
+	char header[64];
+	snprintf(header, sizeof(header), "labwc-icon-index %d %016llx",
+		ICON_INDEX_VERSION, (unsigned long long)loader->index_stamp);
+	if ((size_t)(eol - data) != strlen(header)
+			|| memcmp(data, header, eol - data)) {
+		wlr_log(WLR_DEBUG, "icon index is outdated");
+		return;
+	}
+
+	for (const char *line = eol + 1; line < end; line = eol + 1) {
+		eol = memchr(line, '\n', end - line);
+		if (!eol) {
+			break;
+		}
+		/* The path is everything after the last tab */
+		const char *sep = eol;
+		while (sep > line && sep[-1] != '\t') {
+			sep--;
+		}
+		/* No tab: malformed line, skip it */
+		if (sep == line) {
+			continue;
+		}
+		/* An empty path (sep == eol) is kept as a negative entry */
+		g_hash_table_insert(loader->index,
+			g_strndup(line, sep - 1 - line),
+			g_strndup(sep, eol - sep));
+	}
+}
+
+/* Runs on the worker thread */
+static void
+index_load(struct icon_loader *loader)
+{
+	loader->index = g_hash_table_new_full(g_str_hash, g_str_equal,
+		g_free, g_free);
+	loader->index_dirty = false;
+	if (!loader->index_path) {
+		return;
+	}
+
+	int fd = open(loader->index_path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		return;
+	}
+	struct stat st;
+	if (fstat(fd, &st) || st.st_size == 0) {
+		close(fd);
+		return;
+	}
+	void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) {
+		wlr_log_errno(WLR_ERROR, "failed to map %s", loader->index_path);
+		return;
+	}
+	index_parse(loader, data, st.st_size);
+	munmap(data, st.st_size);
+
+	wlr_log(WLR_DEBUG, "loaded %u entries from icon index",
+		g_hash_table_size(loader->index));
+}
+
+static void
+mkdir_for_file(const char *path)
+{
+	char *dir = xstrdup(path);
+	for (char *p = strchr(dir + 1, '/'); p; p = strchr(p + 1, '/')) {
+		*p = '\0';
+		if (mkdir(dir, 0700) && errno != EEXIST) {
+			break;
+		}
+		*p = '/';
+	}
+	free(dir);
+}
+
+/* Runs on the worker thread, when it is idle or about to exit */
+static void
+index_save(struct icon_loader *loader)
+{
+	loader->index_dirty = false;
+	if (!loader->index_path) {
+		return;
+	}
+	mkdir_for_file(loader->index_path);
+
+	char *tmp_path = strdup_printf("%s.tmp", loader->index_path);
+	FILE *fp = fopen(tmp_path, "we");
+	if (!fp) {
+		wlr_log_errno(WLR_DEBUG, "failed to write %s", tmp_path);
+		free(tmp_path);
+		return;
+	}
+
+	fprintf(fp, "labwc-icon-index %d %016llx\n",
+		ICON_INDEX_VERSION, (unsigned long long)loader->index_stamp);
+	GHashTableIter iter;
+	gpointer key, value;
+	g_hash_table_iter_init(&iter, loader->index);
+	while (g_hash_table_iter_next(&iter, &key, &value)) {
+		fprintf(fp, "%s\t%s\n", (char *)key, (char *)value);
+	}
+
+	if (fclose(fp) || rename(tmp_path, loader->index_path)) {
+		wlr_log_errno(WLR_DEBUG, "failed to write %s", loader->index_path);
+		unlink(tmp_path);
+	}
+	free(tmp_path);
 }
 
 struct icon_ctx {
@@ -205,54 +867,55 @@ err:
  * (e.g. "thunderbird" matches "org.mozilla.Thunderbird.desktop"
  * and "XTerm" matches "xterm.desktop"). This is not per any spec
  * but is needed to find icons for existing applications.
+ *
+ * Uses the indexes built by build_fuzzy_index() and returns the same
+ * entry that a linear search through the database would find.
  */
 static struct sfdo_desktop_entry *
-get_db_entry_by_id_fuzzy(struct sfdo_desktop_db *db, const char *app_id)
+get_db_entry_by_id_fuzzy(struct icon_loader *loader, const char *app_id)
 {
-	size_t n_entries;
-	struct sfdo_desktop_entry **entries = sfdo_desktop_db_get_entries(db, &n_entries);
+	char *key = g_ascii_strdown(app_id, -1);
+	size_t by_id_base = GPOINTER_TO_SIZE(
+		g_hash_table_lookup(loader->fuzzy.by_id_base, key));
+	size_t by_wm_class = GPOINTER_TO_SIZE(
+		g_hash_table_lookup(loader->fuzzy.by_wm_class, key));
+	g_free(key);
 
-	for (size_t i = 0; i < n_entries; i++) {
-		struct sfdo_desktop_entry *entry = entries[i];
-		const char *desktop_id = sfdo_desktop_entry_get_id(entry, NULL);
-		/* Get portion of desktop ID after last '.' */
-		const char *dot = strrchr(desktop_id, '.');
-		const char *desktop_id_base = dot ? (dot + 1) : desktop_id;
-
-		if (!strcasecmp(app_id, desktop_id_base)) {
-			return entry;
-		}
-
-		/* sfdo_desktop_entry_get_startup_wm_class() asserts against APPLICATION */
-		if (sfdo_desktop_entry_get_type(entry) != SFDO_DESKTOP_ENTRY_APPLICATION) {
-			continue;
-		}
-
-		/* Try desktop entry's StartupWMClass also */
-		const char *wm_class =
-			sfdo_desktop_entry_get_startup_wm_class(entry, NULL);
-		if (wm_class && !strcasecmp(app_id, wm_class)) {
-			return entry;
-		}
+	/* Both fields match per entry, so the earlier entry wins */
+	size_t index;
+	if (by_id_base && by_wm_class) {
+		index = MIN(by_id_base, by_wm_class);
+	} else {
+		index = by_id_base ? by_id_base : by_wm_class;
+	}
+	if (!index) {
+		return NULL;
 	}
 
-	return NULL;
+	size_t n_entries;
+	struct sfdo_desktop_entry **entries =
+		sfdo_desktop_db_get_entries(loader->desktop_db, &n_entries);
+	return entries[index - 1];
 }
 
-struct lab_data_buffer *
-icon_loader_lookup(struct server *server, const char *app_id, int size,
-		float scale)
+/*
+ * Resolves the icon file for app_id from its desktop entry and the icon
+ * theme. Runs on the worker thread. Return 0 on success and -1 on error.
+ * The calling function is responsible for free()ing ctx->path
+ */
+static int
+resolve_icon(struct icon_ctx *ctx, struct icon_loader *loader,
+		const char *app_id, int size, float scale)
 {
-	struct icon_loader *loader = server->icon_loader;
-	if (!loader) {
-		return NULL;
+	if (!load_databases(loader)) {
+		return -1;
 	}
 
 	const char *icon_name = NULL;
 	struct sfdo_desktop_entry *entry = sfdo_desktop_db_get_entry_by_id(
 		loader->desktop_db, app_id, SFDO_NT);
 	if (!entry) {
-		entry = get_db_entry_by_id_fuzzy(loader->desktop_db, app_id);
+		entry = get_db_entry_by_id_fuzzy(loader, app_id);
 	}
 	if (entry) {
 		icon_name = sfdo_desktop_entry_get_icon(entry, NULL);
@@ -265,18 +928,56 @@ icon_loader_lookup(struct server *server, const char *app_id, int size,
 	int lookup_scale = MAX((int)scale, 1);
 	int lookup_size = lroundf(size * scale / lookup_scale);
 
-	struct icon_ctx ctx = {0};
-	int ret;
 	if (!icon_name) {
 		/* fall back to app id */
-		ret = process_rel_name(&ctx, app_id, loader, lookup_size, lookup_scale);
+		return process_rel_name(ctx, app_id, loader, lookup_size, lookup_scale);
 	} else if (icon_name[0] == '/') {
-		ret = process_abs_name(&ctx, icon_name);
+		return process_abs_name(ctx, icon_name);
 	} else {
 		/* this should be the case for most icons */
-		ret = process_rel_name(&ctx, icon_name, loader, lookup_size, lookup_scale);
+		return process_rel_name(ctx, icon_name, loader, lookup_size, lookup_scale);
+	}
+}
+
+/* Runs on the worker thread */
+static struct lab_data_buffer *
+lookup_icon(struct icon_loader *loader, const char *app_id, int size,
+		float scale, char **path)
+{
+	if (!loader->index) {
+		index_load(loader);
 	}
-	if (ret < 0) {
+
+	struct icon_ctx ctx = {0};
+	char *key = g_strdup_printf("%s\t%d\t%g", app_id, size, scale);
+	const char *indexed_path = g_hash_table_lookup(loader->index, key);
+	if (indexed_path && !*indexed_path) {
+		/* Known to have no icon, see below */
+		g_free(key);
+		return NULL;
+	} else if (indexed_path && file_exists(indexed_path)
+			&& !process_abs_name(&ctx, indexed_path)) {
+		g_free(key);
+	} else if (!resolve_icon(&ctx, loader, app_id, size, scale)) {
+		if (!strpbrk(key, "\n") && !strpbrk(ctx.path, "\t\n")) {
+			g_hash_table_insert(loader->index, key, g_strdup(ctx.path));
+			loader->index_dirty = true;
+		} else {
+			g_free(key);
+		}
+	} else if (loader->desktop_db && loader->icon_theme
+			&& !strpbrk(key, "\n")) {
+		/*
+		 * Remember apps without an icon so that they do not cause a
+		 * full scan of the databases in every session. The entry is
+		 * dropped along with the index when .desktop files or icon
+		 * themes are added.
+		 */
+		g_hash_table_insert(loader->index, key, g_strdup(""));
+		loader->index_dirty = true;
+		return NULL;
+	} else {
+		g_free(key);
 		return NULL;
 	}
 
@@ -298,6 +999,72 @@ icon_loader_lookup(struct server *server, const char *app_id, int size,
 		break;
 	}
 
-	free(ctx.path);
+	if (icon_buffer) {
+		*path = ctx.path;
+	} else {
+		free(ctx.path);
+	}
 	return icon_buffer;
 }
+
+struct icon_request *
+icon_loader_request(struct server *server, const char *app_id, int size,
+		float scale, void (*callback)(struct lab_data_buffer *buffer,
+			void *data), void *data)
+{
+	struct icon_loader *loader = server->icon_loader;
+	if (!loader) {
+		return NULL;
+	}
+
+	struct icon_cache_entry *entry =
+		cache_find(loader, app_id, NULL, size, scale);
+	if (entry) {
+		loader->cache.hits++;
+		wl_list_remove(&entry->link);
+		wl_list_insert(&loader->cache.entries, &entry->link);
+		callback(entry->buffer, data);
+		return NULL;
+	}
+	loader->cache.misses++;
+
+	struct icon_request *request = znew(*request);
+	request->app_id = xstrdup(app_id);
+	request->size = size;
+	request->scale = scale;
+	request->callback = callback;
+	request->data = data;
+
+	pthread_mutex_lock(&loader->lock);
+	wl_list_insert(&loader->queued, &request->link);
+	pthread_cond_signal(&loader->cond);
+	pthread_mutex_unlock(&loader->lock);
+
+	return request;
+}
+
+void
+icon_request_cancel(struct server *server, struct icon_request *request)
+{
+	struct icon_loader *loader = server->icon_loader;
+	assert(loader);
+
+	pthread_mutex_lock(&loader->lock);
+	request->cancelled = true;
+	pthread_mutex_unlock(&loader->lock);
+}
+
+void
+icon_loader_get_cache_stats(struct server *server,
+		struct icon_cache_stats *stats)
+{
+	*stats = (struct icon_cache_stats){0};
+	struct icon_loader *loader = server->icon_loader;
+	if (!loader) {
+		return;
+	}
+	stats->entries = wl_list_length(&loader->cache.entries);
+	stats->bytes = loader->cache.bytes;
+	stats->hits = loader->cache.hits;
+	stats->misses = loader->cache.misses;
+}
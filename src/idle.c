@@ -1,7 +1,9 @@
 // SPDX-License-Identifier: GPL-2.0-only
-
+#define _POSIX_C_SOURCE 200809L
 #include <assert.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <time.h>
 #include <wlr/types/wlr_idle_notify_v1.h>
 #include <wlr/types/wlr_idle_inhibit_v1.h>
 #include "common/mem.h"
@@ -19,6 +21,7 @@ struct lab_idle_manager {
 		struct wl_listener on_new_inhibitor;
 	} inhibitor;
 	struct wlr_seat *wlr_seat;
+	struct timespec last_activity;
 	struct wl_listener on_display_destroy;
 };
 
@@ -75,6 +78,7 @@ idle_manager_create(struct wl_display *display, struct wlr_seat *wlr_seat)
 	assert(!manager);
 	manager = znew(*manager);
 	manager->wlr_seat = wlr_seat;
+	clock_gettime(CLOCK_MONOTONIC, &manager->last_activity);
 
 	manager->ext = wlr_idle_notifier_v1_create(display);
 
@@ -100,5 +104,20 @@ idle_manager_notify_activity(struct wlr_seat *seat)
 		return;
 	}
 
+	clock_gettime(CLOCK_MONOTONIC, &manager->last_activity);
 	wlr_idle_notifier_v1_notify_activity(manager->ext, seat);
 }
+
+int
+idle_manager_get_idle_msec(void)
+{
+	if (!manager) {
+		return 0;
+	}
+
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	int64_t msec = (now.tv_sec - manager->last_activity.tv_sec) * 1000
+		+ (now.tv_nsec - manager->last_activity.tv_nsec) / 1000000;
+	return msec > INT32_MAX ? INT32_MAX : (int)msec;
+}
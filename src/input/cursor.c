@@ -271,28 +271,6 @@ process_cursor_move(struct server *server, uint32_t time)
 static void
 process_cursor_resize(struct server *server, uint32_t time)
 {
-	/* Rate-limit resize events respecting monitor refresh rate */
-	static uint32_t last_resize_time = 0;
-	static struct view *last_resize_view = NULL;
-
-	if (server->grabbed_view == last_resize_view) {
-		int32_t refresh = 0;
-		if (output_is_usable(last_resize_view->output)) {
-			refresh = last_resize_view->output->wlr_output->refresh;
-		}
-		/* Limit to 250Hz if refresh rate is not available */
-		if (refresh <= 0) {
-			refresh = 250000;
-		}
-		/* Not caring overflow, but it won't be observable */
-		if (time - last_resize_time < 1000000 / (uint32_t)refresh) {
-			return;
-		}
-	}
-
-	last_resize_time = time;
-	last_resize_view = server->grabbed_view;
-
 	double dx = server->seat.cursor->x - server->grab_x;
 	double dy = server->seat.cursor->y - server->grab_y;
 
@@ -337,6 +315,90 @@ process_cursor_resize(struct server *server, uint32_t time)
 	}
 }
 
+static void
+process_grab_motion(struct server *server, uint32_t time)
+{
+	if (server->input_mode == LAB_INPUT_STATE_MOVE) {
+		process_cursor_move(server, time);
+	} else if (server->input_mode == LAB_INPUT_STATE_RESIZE) {
+		process_cursor_resize(server, time);
+	}
+}
+
+/* Returns the refresh interval of the output showing the grabbed view */
+static int
+grab_motion_interval_ms(struct server *server)
+{
+	struct view *view = server->grabbed_view;
+	int32_t refresh = 0;
+	if (view && output_is_usable(view->output)) {
+		refresh = view->output->wlr_output->refresh;
+	}
+	/* Limit to 250Hz if refresh rate is not available */
+	if (refresh <= 0) {
+		refresh = 250000;
+	}
+	return MAX(1000000 / refresh, 1);
+}
+
+static int
+handle_grab_motion_timeout(void *data)
+{
+	struct seat *seat = data;
+	struct server *server = seat->server;
+
+	if (!seat->grab_motion.pending) {
+		/* No motion during the last interval, stop throttling */
+		seat->grab_motion.throttled = false;
+		return 0;
+	}
+
+	seat->grab_motion.pending = false;
+	process_grab_motion(server, seat->grab_motion.time);
+	wl_event_source_timer_update(seat->grab_motion.timer,
+		grab_motion_interval_ms(server));
+	return 0;
+}
+
+/*
+ * High polling-rate mice emit up to several thousand motion events per
+ * second. During interactive move/resize each of them would cause edge
+ * resistance, snapping overlay checks and a configure of the grabbed view,
+ * so we apply the first motion immediately and after that only the latest
+ * cursor position once per output refresh interval.
+ */
+static void
+throttle_grab_motion(struct server *server, uint32_t time)
+{
+	struct seat *seat = &server->seat;
+
+	if (seat->grab_motion.throttled) {
+		seat->grab_motion.pending = true;
+		seat->grab_motion.time = time;
+		return;
+	}
+
+	process_grab_motion(server, time);
+
+	if (!seat->grab_motion.timer) {
+		seat->grab_motion.timer = wl_event_loop_add_timer(
+			server->wl_event_loop, handle_grab_motion_timeout, seat);
+	}
+	seat->grab_motion.throttled = true;
+	wl_event_source_timer_update(seat->grab_motion.timer,
+		grab_motion_interval_ms(server));
+}
+
+/* Apply motion held back by throttle_grab_motion() right away */
+static void
+flush_grab_motion(struct seat *seat)
+{
+	if (seat->grab_motion.pending) {
+		seat->grab_motion.pending = false;
+		process_grab_motion(seat->server, seat->grab_motion.time);
+	}
+}
+
 void
 cursor_set(struct seat *seat, enum lab_cursors cursor)
 {
@@ -556,11 +618,9 @@ bool
 cursor_process_motion(struct server *server, uint32_t time, double *sx, double *sy)
 {
 	/* If the mode is non-passthrough, delegate to those functions. */
-	if (server->input_mode == LAB_INPUT_STATE_MOVE) {
-		process_cursor_move(server, time);
-		return false;
-	} else if (server->input_mode == LAB_INPUT_STATE_RESIZE) {
-		process_cursor_resize(server, time);
+	if (server->input_mode == LAB_INPUT_STATE_MOVE
+			|| server->input_mode == LAB_INPUT_STATE_RESIZE) {
+		throttle_grab_motion(server, time);
 		return false;
 	}
 
@@ -1123,6 +1183,8 @@ cursor_finish_button_release(struct seat *seat, uint32_t button)
 
 	if (server->input_mode == LAB_INPUT_STATE_MOVE
 			|| server->input_mode == LAB_INPUT_STATE_RESIZE) {
+		/* Make sure the view ends up at the final cursor position */
+		flush_grab_motion(seat);
 		if (resize_outlines_enabled(server->grabbed_view)) {
 			resize_outlines_finish(server->grabbed_view);
 		}
@@ -1479,6 +1541,11 @@ void cursor_finish(struct seat *seat)
 	wl_list_remove(&seat->cursor_axis.link);
 	wl_list_remove(&seat->cursor_frame.link);
 
+	if (seat->grab_motion.timer) {
+		wl_event_source_remove(seat->grab_motion.timer);
+		seat->grab_motion.timer = NULL;
+	}
+
 	gestures_finish(seat);
 	touch_finish(seat);
 
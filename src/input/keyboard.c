@@ -2,10 +2,13 @@
 #define _POSIX_C_SOURCE 200809L
 #include <assert.h>
 #include <stdlib.h>
+#include <string.h>
 #include <wlr/backend/multi.h>
 #include <wlr/backend/session.h>
 #include <wlr/interfaces/wlr_keyboard.h>
 #include "action.h"
+#include "common/macros.h"
+#include "common/mem.h"
 #include "idle.h"
 #include "input/ime.h"
 #include "input/keyboard.h"
@@ -745,19 +748,88 @@ reset_window_keyboard_layout_groups(struct server *server)
 	keyboard_update_layout(&server->seat, active_view->keyboard_layout);
 }
 
+static const char *const xkb_env_vars[] = {
+	"XKB_DEFAULT_RULES",
+	"XKB_DEFAULT_MODEL",
+	"XKB_DEFAULT_LAYOUT",
+	"XKB_DEFAULT_VARIANT",
+	"XKB_DEFAULT_OPTIONS",
+};
+
 /*
- * Set layout based on environment variables XKB_DEFAULT_LAYOUT,
- * XKB_DEFAULT_OPTIONS, and friends.
+ * Compiling a keymap is expensive, so the one compiled from the XKB_DEFAULT_*
+ * environment variables is shared by all keyboards and only compiled again
+ * once these variables change (on Reconfigure).
  */
+static struct {
+	char *env[ARRAY_SIZE(xkb_env_vars)];
+	struct xkb_keymap *keymap;
+} keymap_cache;
+
 static void
-set_layout(struct server *server, struct wlr_keyboard *kb)
+keymap_cache_clear(void)
 {
-	static bool fallback_mode;
+	for (size_t i = 0; i < ARRAY_SIZE(xkb_env_vars); i++) {
+		zfree(keymap_cache.env[i]);
+	}
+	if (keymap_cache.keymap) {
+		xkb_keymap_unref(keymap_cache.keymap);
+		keymap_cache.keymap = NULL;
+	}
+}
+
+static bool
+keymap_cache_matches_env(void)
+{
+	if (!keymap_cache.keymap) {
+		return false;
+	}
+	for (size_t i = 0; i < ARRAY_SIZE(xkb_env_vars); i++) {
+		const char *value = getenv(xkb_env_vars[i]);
+		const char *cached = keymap_cache.env[i];
+		if (!value != !cached || (value && strcmp(value, cached))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/* The returned keymap is owned by the cache */
+static struct xkb_keymap *
+get_keymap(void)
+{
+	if (keymap_cache_matches_env()) {
+		return keymap_cache.keymap;
+	}
+	keymap_cache_clear();
 
 	struct xkb_rule_names rules = { 0 };
 	struct xkb_context *context = xkb_context_new(XKB_CONTEXT_NO_FLAGS);
 	struct xkb_keymap *keymap = xkb_map_new_from_names(context, &rules,
 		XKB_KEYMAP_COMPILE_NO_FLAGS);
+	xkb_context_unref(context);
+	if (!keymap) {
+		return NULL;
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(xkb_env_vars); i++) {
+		const char *value = getenv(xkb_env_vars[i]);
+		keymap_cache.env[i] = value ? xstrdup(value) : NULL;
+	}
+	keymap_cache.keymap = keymap;
+	return keymap;
+}
+
+/*
+ * Set layout based on environment variables XKB_DEFAULT_LAYOUT,
+ * XKB_DEFAULT_OPTIONS, and friends.
+ */
+static void
+set_layout(struct server *server, struct wlr_keyboard *kb)
+{
+	static bool fallback_mode;
+
+	struct xkb_keymap *keymap = get_keymap();
 
 	/*
 	 * With XKB_DEFAULT_LAYOUT set to empty odd things happen with
@@ -767,11 +839,12 @@ set_layout(struct server *server, struct wlr_keyboard *kb)
 	const char *layout = getenv("XKB_DEFAULT_LAYOUT");
 	bool layout_empty = layout && !*layout;
 	if (keymap && !layout_empty) {
-		if (!wlr_keyboard_keymaps_match(kb->keymap, keymap)) {
+		/* Keyboards usually share the cached keymap already */
+		if (kb->keymap != keymap
+				&& !wlr_keyboard_keymaps_match(kb->keymap, keymap)) {
 			wlr_keyboard_set_keymap(kb, keymap);
 			reset_window_keyboard_layout_groups(server);
 		}
-		xkb_keymap_unref(keymap);
 	} else {
 		wlr_log(WLR_ERROR, "failed to create xkb keymap for layout '%s'",
 			layout);
@@ -782,7 +855,6 @@ set_layout(struct server *server, struct wlr_keyboard *kb)
 			set_layout(server, kb);
 		}
 	}
-	xkb_context_unref(context);
 }
 
 void
@@ -828,4 +900,5 @@ keyboard_group_finish(struct seat *seat)
 		wlr_keyboard_group_destroy(seat->keyboard_group);
 		seat->keyboard_group = NULL;
 	}
+	keymap_cache_clear();
 }
@@ -106,7 +106,7 @@ handle_button(struct wl_listener *listener, void *data)
 		wl_container_of(listener, pad, handlers.button);
 	struct wlr_tablet_pad_button_event *ev = data;
 
-	if (!rc.tablet.force_mouse_emulation
+	if (!pad->seat->force_tablet_mouse_emulation
 			&& pad->pad_v2 && pad->current_surface) {
 		wlr_tablet_v2_tablet_pad_notify_button(pad->pad_v2, ev->button,
 			ev->time_msec,
@@ -132,7 +132,7 @@ handle_ring(struct wl_listener *listener, void *data)
 		wl_container_of(listener, pad, handlers.ring);
 	struct wlr_tablet_pad_ring_event *ev = data;
 
-	if (!rc.tablet.force_mouse_emulation
+	if (!pad->seat->force_tablet_mouse_emulation
 			&& pad->pad_v2 && pad->current_surface) {
 		wlr_tablet_v2_tablet_pad_notify_ring(pad->pad_v2,
 			ev->ring, ev->position,
@@ -148,7 +148,7 @@ handle_strip(struct wl_listener *listener, void *data)
 		wl_container_of(listener, pad, handlers.strip);
 	struct wlr_tablet_pad_strip_event *ev = data;
 
-	if (!rc.tablet.force_mouse_emulation
+	if (!pad->seat->force_tablet_mouse_emulation
 			&& pad->pad_v2 && pad->current_surface) {
 		wlr_tablet_v2_tablet_pad_notify_strip(pad->pad_v2,
 			ev->strip, ev->position,
@@ -137,7 +137,7 @@ tablet_get_coords(struct drawing_tablet *tablet, double *x, double *y, double *d
 	 * will trigger the fallback to cursor move/button emulation in the
 	 * tablet signal handlers.
 	 */
-	if (rc.tablet.force_mouse_emulation
+	if (tablet->seat->force_tablet_mouse_emulation
 			|| !tablet->tablet_v2) {
 		return NULL;
 	}
@@ -276,7 +276,7 @@ handle_tablet_tool_proximity(struct wl_listener *listener, void *data)
 	 * the fallback to cursor move/button emulation in the tablet signal
 	 * handlers.
 	 */
-	if (!rc.tablet.force_mouse_emulation
+	if (!tablet->seat->force_tablet_mouse_emulation
 			&& tablet->seat->server->tablet_manager && !tool) {
 		/*
 		 * Unfortunately `wlr_tool` is only present in the events, so
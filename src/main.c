@@ -209,10 +209,11 @@ main(int argc, char *argv[])
 	server_init(&server);
 	server_start(&server);
 
+	/* theme_init() relies on rc.theme for ssd_get_corner_width() */
 	struct theme theme = { 0 };
-	theme_init(&theme, &server, rc.theme_name);
 	rc.theme = &theme;
 	server.theme = &theme;
+	theme_init(&theme, &server, rc.theme_name);
 
 	menu_init(&server);
 
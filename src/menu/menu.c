@@ -15,9 +15,11 @@
 #include "common/dir.h"
 #include "common/font.h"
 #include "common/list.h"
+#include "common/macros.h"
 #include "common/mem.h"
 #include "common/nodename.h"
 #include "common/scaled-font-buffer.h"
+#include "common/scaled-scene-buffer.h"
 #include "common/scene-helpers.h"
 #include "common/spawn.h"
 #include "common/string-helpers.h"
@@ -31,6 +33,9 @@
 #define PIPEMENU_MAX_BUF_SIZE 1048576  /* 1 MiB */
 #define PIPEMENU_TIMEOUT_IN_MS 4000    /* 4 seconds */
 
+#define PRERENDER_ITEMS_PER_SLICE 8
+#define PRERENDER_INTERVAL_IN_MS 1
+
 /* state-machine variables for processing <item></item> */
 static bool in_item;
 static struct menuitem *current_item;
@@ -42,6 +47,13 @@ static struct menu *current_menu;
 static bool waiting_for_pipe_menu;
 static struct menuitem *selected_item;
 
+/* state for rendering static menus ahead of their first use */
+static struct wl_event_source *prerender_source;
+
+/* Sizes and modification times of the menu files read by menu_init() */
+static struct buf menu_files_snapshot = { .data = "" };
+static int prerender_next_item;
+
 struct menu_pipe_context {
 	struct server *server;
 	struct menuitem *item;
@@ -756,6 +768,9 @@ parse_xml(const char *filename, struct server *server)
 	struct wl_list paths;
 	paths_config_create(&paths, filename);
 
+	buf_clear(&menu_files_snapshot);
+	paths_stat_snapshot(&paths, &menu_files_snapshot);
+
 	bool should_merge_config = rc.merge_config;
 	struct wl_list *(*iter)(struct wl_list *list);
 	iter = should_merge_config ? paths_get_prev : paths_get_next;
@@ -1100,6 +1115,109 @@ init_windowmenu(struct server *server)
 	}
 }
 
+static int
+get_scales_in_use(struct server *server, double *scales, int max)
+{
+	int nr_scales = 0;
+	struct output *output;
+	wl_list_for_each(output, &server->outputs, link) {
+		if (!output_is_usable(output)) {
+			continue;
+		}
+		double scale = output->wlr_output->scale;
+		bool seen = false;
+		for (int i = 0; i < nr_scales; i++) {
+			if (scales[i] == scale) {
+				seen = true;
+				break;
+			}
+		}
+		if (!seen && nr_scales < max) {
+			scales[nr_scales++] = scale;
+		}
+	}
+	return nr_scales;
+}
+
+static void
+prerender_item(struct menuitem *item, double *scales, int nr_scales)
+{
+	for (int i = 0; i < nr_scales; i++) {
+		/* Separator lines do not have a font buffer */
+		if (item->normal.buffer) {
+			scaled_font_buffer_prerender(item->normal.buffer,
+				scales[i]);
+		}
+		if (item->selectable) {
+			scaled_font_buffer_prerender(item->selected.buffer,
+				scales[i]);
+		}
+	}
+}
+
+/*
+ * Menu items are rendered for scale 1 when they are created, so the first
+ * time a menu is shown on an output with another scale, all of its items
+ * would be rendered again while the user waits. To avoid that, we render
+ * the static menus for all scales in use in small slices after startup,
+ * Reconfigure and output changes.
+ *
+ * Items are addressed by their index rather than by pointer because
+ * pipemenus and the client-list menus may be rebuilt between two slices.
+ */
+
+/* These are rebuilt every time they are opened, so not worth prerendering */
+static bool
+menu_is_dynamic(struct menu *menu)
+{
+	return menu->is_pipemenu
+		|| !strcmp(menu->id, "client-list-combined-menu")
+		|| !strcmp(menu->id, "client-send-to-menu");
+}
+
+static int
+handle_prerender_timeout(void *data)
+{
+	struct server *server = data;
+	double scales[LAB_SCALED_BUFFER_MAX_CACHE];
+	int nr_scales = get_scales_in_use(server, scales, ARRAY_SIZE(scales));
+
+	int index = 0;
+	int end = prerender_next_item + PRERENDER_ITEMS_PER_SLICE;
+	struct menu *menu;
+	wl_list_for_each(menu, &server->menus, link) {
+		if (menu_is_dynamic(menu)) {
+			continue;
+		}
+		struct menuitem *item;
+		wl_list_for_each(item, &menu->menuitems, link) {
+			if (index >= end) {
+				/* Give other events a chance before the next slice */
+				prerender_next_item = end;
+				wl_event_source_timer_update(prerender_source,
+					PRERENDER_INTERVAL_IN_MS);
+				return 0;
+			}
+			if (index >= prerender_next_item) {
+				prerender_item(item, scales, nr_scales);
+			}
+			index++;
+		}
+	}
+	return 0;
+}
+
+void
+menu_prerender(struct server *server)
+{
+	/* Nothing to do before menu_init() or after menu_finish() */
+	if (!prerender_source) {
+		return;
+	}
+	prerender_next_item = 0;
+	wl_event_source_timer_update(prerender_source, PRERENDER_INTERVAL_IN_MS);
+}
+
 void
 menu_init(struct server *server)
 {
@@ -1111,6 +1229,14 @@ menu_init(struct server *server)
 	init_client_send_to_menu(server);
 	post_processing(server);
 	validate(server);
+
+	/*
+	 * At startup the outputs are usually not configured yet, in which
+	 * case this is a no-op and the first layout change does the work.
+	 */
+	prerender_source = wl_event_loop_add_timer(server->wl_event_loop,
+		handle_prerender_timeout, server);
+	menu_prerender(server);
 }
 
 static void
@@ -1183,6 +1309,12 @@ void
 menu_finish(struct server *server)
 {
 	menu_free_from(server, NULL);
+	buf_reset(&menu_files_snapshot);
+
+	if (prerender_source) {
+		wl_event_source_remove(prerender_source);
+		prerender_source = NULL;
+	}
 
 	/* Reset state vars for starting fresh when Reload is triggered */
 	current_item = NULL;
@@ -1722,6 +1854,20 @@ menu_close_root(struct server *server)
 	server->input_mode = LAB_INPUT_STATE_PASSTHROUGH;
 }
 
+bool
+menu_files_changed(void)
+{
+	struct wl_list paths;
+	paths_config_create(&paths, "menu.xml");
+	struct buf snapshot = BUF_INIT;
+	paths_stat_snapshot(&paths, &snapshot);
+	paths_destroy(&paths);
+
+	bool changed = strcmp(snapshot.data, menu_files_snapshot.data);
+	buf_reset(&snapshot);
+	return changed;
+}
+
 void
 menu_reconfigure(struct server *server)
 {
@@ -2,6 +2,7 @@
 #include <assert.h>
 #include <ctype.h>
 #include <wlr/util/log.h>
+#include "common/array.h"
 #include "common/mem.h"
 #include "config/rcxml.h"
 #include "view.h"
@@ -22,6 +23,14 @@ struct field_converter {
 
 static const struct field_converter field_converter[];
 
+/* A conversion or a run of literal text in a custom field format */
+struct field_format_op {
+	/* LAB_FIELD_NONE for literal text */
+	enum window_switcher_field_content content;
+	/* The literal text, or the printf format for padding (may be NULL) */
+	char *str;
+};
+
 /* Internal helpers */
 
 static const char *
@@ -179,18 +188,36 @@ field_set_title_short(struct buf *buf, struct view *view, const char *format)
 }
 
 static void
-field_set_custom(struct buf *buf, struct view *view, const char *format)
+format_add_op(struct wl_array *ops, enum window_switcher_field_content content,
+		const char *str)
 {
-	if (!format) {
-		wlr_log(WLR_ERROR, "Missing format for custom window switcher field");
-		return;
+	struct field_format_op op = {
+		.content = content,
+		.str = str ? xstrdup(str) : NULL,
+	};
+	array_add(ops, op);
+}
+
+static void
+format_add_text(struct wl_array *ops, struct buf *text)
+{
+	if (text->len) {
+		format_add_op(ops, LAB_FIELD_NONE, text->data);
+		buf_clear(text);
 	}
+}
 
+/*
+ * Parse the printf-like format of a custom field once when the config is
+ * loaded, so that rendering the window switcher does not have to.
+ */
+static void
+compile_custom_format(struct window_switcher_field *field)
+{
+	const char *format = field->format;
 	char fmt[LAB_FIELD_SINGLE_FMT_MAX_LEN];
 	unsigned char fmt_position = 0;
-
-	struct buf field_result = BUF_INIT;
-	char converted_field[4096];
+	struct buf text = BUF_INIT;
 
 	for (const char *p = format; *p; p++) {
 		if (!fmt_position) {
@@ -201,7 +228,7 @@ field_set_custom(struct buf *buf, struct view *view, const char *format)
 				 * Just relay anything not part of a
 				 * format string to the output buffer.
 				 */
-				buf_add_char(buf, *p);
+				buf_add_char(&text, *p);
 			}
 			continue;
 		}
@@ -225,33 +252,63 @@ field_set_custom(struct buf *buf, struct view *view, const char *format)
 		}
 
 		/* Handlers */
+		bool found = false;
 		for (unsigned char i = 0; i < LAB_FIELD_COUNT; i++) {
 			if (*p != field_converter[i].fmt_char) {
 				continue;
 			}
+			format_add_text(&field->format_ops, &text);
 
-			/* Generate the actual content*/
-			field_converter[i].fn(&field_result, view, /*format*/ NULL);
-
-			/* Throw it at snprintf to allow formatting / padding */
+			/* A plain "%X" needs no snprintf() for padding */
 			fmt[fmt_position++] = 's';
 			fmt[fmt_position++] = '\0';
-			snprintf(converted_field, sizeof(converted_field),
-				fmt, field_result.data);
+			format_add_op(&field->format_ops, i,
+				strcmp(fmt, "%s") ? fmt : NULL);
+			found = true;
+			break;
+		}
 
-			/* And finally write it to the output buffer */
-			buf_add(buf, converted_field);
-			goto reset_format;
+		if (!found) {
+			wlr_log(WLR_ERROR,
+				"invalid format character found for osd %s: '%c'",
+				format, *p);
 		}
 
-		wlr_log(WLR_ERROR,
-			"invalid format character found for osd %s: '%c'",
-			format, *p);
+		/* Reset format string */
+		fmt_position = 0;
+	}
+	format_add_text(&field->format_ops, &text);
+	buf_reset(&text);
+}
 
-reset_format:
-		/* Reset format string and tmp field result buffer */
+static void
+field_set_custom(struct buf *buf, struct view *view,
+		struct window_switcher_field *field)
+{
+	struct buf field_result = BUF_INIT;
+	char converted_field[4096];
+
+	struct field_format_op *op;
+	wl_array_for_each(op, &field->format_ops) {
+		if (op->content == LAB_FIELD_NONE) {
+			buf_add(buf, op->str);
+			continue;
+		}
+		if (!op->str) {
+			field_converter[op->content].fn(buf, view, /*format*/ NULL);
+			continue;
+		}
+
+		/* Generate the actual content*/
+		field_converter[op->content].fn(&field_result, view, /*format*/ NULL);
+
+		/* Throw it at snprintf to allow formatting / padding */
+		snprintf(converted_field, sizeof(converted_field),
+			op->str, field_result.data);
+
+		/* And finally write it to the output buffer */
+		buf_add(buf, converted_field);
 		buf_clear(&field_result);
-		fmt_position = 0;
 	}
 	buf_reset(&field_result);
 }
@@ -269,8 +326,8 @@ static const struct field_converter field_converter[LAB_FIELD_COUNT] = {
 	[LAB_FIELD_OUTPUT_SHORT]       = { 'o', field_set_output_short },
 	[LAB_FIELD_TITLE]              = { 'T', field_set_title },
 	[LAB_FIELD_TITLE_SHORT]        = { 't', field_set_title_short },
-	/* fmt_char can never be matched so prevents LAB_FIELD_CUSTOM recursion */
-	[LAB_FIELD_CUSTOM]             = { '\0', field_set_custom },
+	/* Handled by field_set_custom(), fmt_char can never be matched */
+	[LAB_FIELD_CUSTOM]             = { '\0', NULL },
 };
 
 struct window_switcher_field *
@@ -339,6 +396,9 @@ osd_field_validate(struct window_switcher_field *field)
 		wlr_log(WLR_ERROR, "Invalid OSD field: no width");
 		return false;
 	}
+	if (field->content == LAB_FIELD_CUSTOM) {
+		compile_custom_format(field);
+	}
 	return true;
 }
 
@@ -350,6 +410,10 @@ osd_field_get_content(struct window_switcher_field *field,
 		wlr_log(WLR_ERROR, "Invalid window switcher field type");
 		return;
 	}
+	if (field->content == LAB_FIELD_CUSTOM) {
+		field_set_custom(buf, view, field);
+		return;
+	}
 	assert(field->content < LAB_FIELD_COUNT && field_converter[field->content].fn);
 
 	field_converter[field->content].fn(buf, view, field->format);
@@ -358,6 +422,11 @@ osd_field_get_content(struct window_switcher_field *field,
 void
 osd_field_free(struct window_switcher_field *field)
 {
+	struct field_format_op *op;
+	wl_array_for_each(op, &field->format_ops) {
+		free(op->str);
+	}
+	wl_array_release(&field->format_ops);
 	zfree(field->format);
 	zfree(field);
 }
@@ -24,6 +24,7 @@
 #include "common/scene-helpers.h"
 #include "labwc.h"
 #include "layers.h"
+#include "menu/menu.h"
 #include "node.h"
 #include "output-state.h"
 #include "output-virtual.h"
@@ -103,6 +104,119 @@ output_apply_gamma(struct output *output)
 	wlr_output_state_finish(&pending);
 }
 
+#define LAYOUT_CHANGE_TIMEOUT_MS 200
+
+static bool
+view_is_shown(struct view *view)
+{
+	if (!view->mapped || view->minimized) {
+		return false;
+	}
+	return view->workspace == view->server->workspaces.current
+		|| view_is_omnipresent(view);
+}
+
+/*
+ * Only views with a configure in flight are waited for. Whether they end
+ * up with exactly the requested size does not matter, as size hints and
+ * increments often prevent that.
+ */
+static bool
+view_has_pending_configure(struct view *view)
+{
+	if (view->pending_configure_serial) {
+		return true;
+	}
+	/* X11 has no configure serials, so wait for the next commit */
+	return view->type == LAB_XWAYLAND_VIEW
+		&& (view->current.width != view->pending.width
+			|| view->current.height != view->pending.height);
+}
+
+static bool
+views_await_resize(struct server *server)
+{
+	struct view *view;
+	wl_list_for_each(view, &server->views, link) {
+		if (view->awaits_layout_change && view_is_shown(view)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static void
+layout_change_finish(struct server *server)
+{
+	wl_event_source_remove(server->layout_change_timeout);
+	server->layout_change_timeout = NULL;
+
+	struct view *view;
+	wl_list_for_each(view, &server->views, link) {
+		view->awaits_layout_change = false;
+	}
+
+	struct output *output;
+	wl_list_for_each(output, &server->outputs, link) {
+		if (output_is_usable(output)) {
+			wlr_output_schedule_frame(output->wlr_output);
+		}
+	}
+}
+
+static int
+handle_layout_change_timeout(void *data)
+{
+	struct server *server = data;
+	wlr_log(WLR_DEBUG, "views did not respond to configure after "
+		"layout change in %d ms", LAYOUT_CHANGE_TIMEOUT_MS);
+	layout_change_finish(server);
+	return 0; /* ignored per wl_event_loop docs */
+}
+
+/*
+ * Called after views have been re-arranged for a new output layout. If
+ * any of them have been asked to resize, hold back rendering until the
+ * clients have responded so that outputs don't show several frames of
+ * half re-arranged state.
+ */
+static void
+layout_change_hold_frames(struct server *server)
+{
+	bool any = false;
+	struct view *view;
+	wl_list_for_each(view, &server->views, link) {
+		if (view_is_shown(view) && view_has_pending_configure(view)) {
+			view->awaits_layout_change = true;
+			any = true;
+		}
+	}
+	if (!any) {
+		return;
+	}
+	if (!server->layout_change_timeout) {
+		server->layout_change_timeout = wl_event_loop_add_timer(
+			server->wl_event_loop, handle_layout_change_timeout,
+			server);
+	}
+	wl_event_source_timer_update(server->layout_change_timeout,
+		LAYOUT_CHANGE_TIMEOUT_MS);
+}
+
+/* Returns true if rendering should be held back for a layout change */
+static bool
+layout_change_pending(struct server *server)
+{
+	if (!server->layout_change_timeout) {
+		return false;
+	}
+	if (views_await_resize(server)) {
+		return true;
+	}
+	layout_change_finish(server);
+	return false;
+}
+
 static void
 output_frame_notify(struct wl_listener *listener, void *data)
 {
@@ -135,6 +249,15 @@ output_frame_notify(struct wl_listener *listener, void *data)
 		 * unrelated output changes.
 		 */
 		output_apply_gamma(output);
+	} else if (layout_change_pending(output->server)) {
+		/*
+		 * Don't send frame done either, otherwise animating
+		 * clients commit right away and schedule the next frame
+		 * without a page flip in between. layout_change_finish()
+		 * schedules a frame on all outputs which flushes the
+		 * callbacks.
+		 */
+		return;
 	} else {
 		struct wlr_scene_output *scene_output = output->scene_output;
 		struct wlr_output_state *pending = &output->pending;
@@ -501,8 +624,12 @@ static void
 output_update_for_layout_change(struct server *server)
 {
 	output_update_all_usable_areas(server, /*layout_changed*/ true);
+	layout_change_hold_frames(server);
 	session_lock_update_for_layout_change(server);
 
+	/* Outputs may have been added or changed their scale */
+	menu_prerender(server);
+
 	/*
 	 * "Move" each wlr_output_cursor (in per-output coordinates) to
 	 * align with the seat cursor. Re-set the cursor image so that
@@ -533,6 +533,7 @@ seat_init(struct server *server)
 
 	wl_list_init(&seat->touch_points);
 	wl_list_init(&seat->constraint_commit.link);
+	seat->force_tablet_mouse_emulation = rc.tablet.force_mouse_emulation;
 	wl_list_init(&seat->inputs);
 	seat->new_input.notify = new_input_notify;
 	wl_signal_add(&server->backend->events.new_input, &seat->new_input);
@@ -605,6 +606,7 @@ seat_reconfigure(struct server *server)
 	cursor_reload(seat);
 	overlay_reconfigure(seat);
 	keyboard_reset_current_keybind();
+	seat->force_tablet_mouse_emulation = rc.tablet.force_mouse_emulation;
 	wl_list_for_each(input, &seat->inputs, link) {
 		switch (input->wlr_input_device->type) {
 		case WLR_INPUT_DEVICE_KEYBOARD:
@@ -3,7 +3,6 @@
 #include "config.h"
 #include <signal.h>
 #include <string.h>
-#include <sys/wait.h>
 #include <wlr/backend/headless.h>
 #include <wlr/backend/multi.h>
 #include <wlr/types/wlr_data_control_v1.h>
@@ -23,6 +22,7 @@
 #include "xwayland-shell-v1-protocol.h"
 #endif
 #include "drm-lease-v1-protocol.h"
+#include "common/spawn.h"
 #include "config/rcxml.h"
 #include "config/session.h"
 #include "decorations.h"
@@ -56,27 +56,52 @@ static struct wl_event_source *sigchld_source;
 static void
 reload_config_and_theme(struct server *server)
 {
-	rcxml_finish();
-	rcxml_read(rc.config_file);
-	theme_finish(server->theme);
-	theme_init(server->theme, server, rc.theme_name);
+	/*
+	 * Only rebuild what is affected by files that have changed since
+	 * they were last read, so that a Reconfigure after editing one
+	 * keybind does not reload the theme, all window decorations and
+	 * the menus.
+	 */
+	bool config_changed = rcxml_config_changed(rc.config_file);
+	if (config_changed) {
+		rcxml_finish();
+		rcxml_read(rc.config_file);
+	} else {
+		wlr_log(WLR_INFO, "config files unchanged, not parsing again");
+	}
 
+	bool theme_changed = theme_needs_reload(server->theme, rc.theme_name);
+	if (theme_changed) {
+		theme_finish(server->theme);
+		theme_init(server->theme, server, rc.theme_name);
+	}
+
+	bool reload_ssd = theme_changed;
 #if HAVE_LIBSFDO
-	icon_loader_finish(server);
-	icon_loader_init(server);
+	if (icon_loader_reload(server)) {
+		reload_ssd = true;
+	}
 #endif
 
-	struct view *view;
-	wl_list_for_each(view, &server->views, link) {
-		view_reload_ssd(view);
+	if (reload_ssd) {
+		struct view *view;
+		wl_list_for_each(view, &server->views, link) {
+			view_reload_ssd(view);
+		}
 	}
 
-	menu_reconfigure(server);
+	if (config_changed || theme_changed || menu_files_changed()) {
+		menu_reconfigure(server);
+	}
 	seat_reconfigure(server);
-	regions_reconfigure(server);
-	resize_indicator_reconfigure(server);
-	kde_server_decoration_update_default();
-	workspaces_reconfigure(server);
+	if (config_changed) {
+		regions_reconfigure(server);
+		kde_server_decoration_update_default();
+		workspaces_reconfigure(server);
+	}
+	if (config_changed || theme_changed) {
+		resize_indicator_reconfigure(server);
+	}
 }
 
 static int
@@ -102,62 +127,20 @@ handle_sigterm(int signal, void *data)
 static int
 handle_sigchld(int signal, void *data)
 {
-	siginfo_t info;
-	info.si_pid = 0;
 	struct server *server = data;
 
-	/* First call waitid() with NOWAIT which doesn't consume the zombie */
-	if (waitid(P_ALL, /*id*/ 0, &info, WEXITED | WNOHANG | WNOWAIT) == -1) {
-		return 0;
-	}
-
-	if (info.si_pid == 0) {
-		/* No children in waitable state */
-		return 0;
-	}
-
-#if HAVE_XWAYLAND
-	/* Ensure that we do not break xwayland lazy initialization */
-	if (server->xwayland && server->xwayland->server
-			&& info.si_pid == server->xwayland->server->pid) {
-		return 0;
-	}
-#endif
-
-	/* And then do the actual (consuming) lookup again */
-	int ret = waitid(P_PID, info.si_pid, &info, WEXITED);
-	if (ret == -1) {
-		wlr_log(WLR_ERROR, "blocking waitid() for %ld failed: %d",
-			(long)info.si_pid, ret);
-		return 0;
-	}
-
-	switch (info.si_code) {
-	case CLD_EXITED:
-		wlr_log(info.si_status == 0 ? WLR_DEBUG : WLR_ERROR,
-			"spawned child %ld exited with %d",
-			(long)info.si_pid, info.si_status);
-		break;
-	case CLD_KILLED:
-	case CLD_DUMPED:
-		; /* works around "a label can only be part of a statement" */
-		const char *signame = strsignal(info.si_status);
-		wlr_log(WLR_ERROR,
-			"spawned child %ld terminated with signal %d (%s)",
-				(long)info.si_pid, info.si_status,
-				signame ? signame : "unknown");
-		break;
-	default:
-		wlr_log(WLR_ERROR,
-			"spawned child %ld terminated unexpectedly: %d"
-			" please report", (long)info.si_pid, info.si_code);
-	}
-
-	if (info.si_pid == server->primary_client_pid) {
-		wlr_log(WLR_INFO, "primary client %ld exited", (long)info.si_pid);
-		wl_display_terminate(server->wl_display);
+	/*
+	 * Programs launched by spawn_async_no_shell() are our children
+	 * until they exit. SIGCHLD is not queued, so reap all exited
+	 * children rather than one per signal.
+	 */
+	pid_t pid;
+	while ((pid = spawn_reap_child()) > 0) {
+		if (pid == server->primary_client_pid) {
+			wlr_log(WLR_INFO, "primary client %ld exited", (long)pid);
+			wl_display_terminate(server->wl_display);
+		}
 	}
-
 	return 0;
 }
 
@@ -426,6 +409,7 @@ server_init(struct server *server)
 	}
 
 	wl_list_init(&server->views);
+	wl_list_init(&server->views_always_on_top);
 	wl_list_init(&server->unmanaged_surfaces);
 
 	server->ssd_hover_state = ssd_hover_state_new();
@@ -626,12 +610,16 @@ server_finish(struct server *server)
 	wl_display_destroy_clients(server->wl_display);
 
 	seat_finish(server);
+	if (server->layout_change_timeout) {
+		wl_event_source_remove(server->layout_change_timeout);
+		server->layout_change_timeout = NULL;
+	}
+#if HAVE_LIBSFDO
+	/* Removes an event source, so must precede wl_display_destroy() */
+	icon_loader_finish(server);
+#endif
 	wl_display_destroy(server->wl_display);
 
 	/* TODO: clean up various scene_tree nodes */
 	workspaces_destroy(server);
-
-#if HAVE_LIBSFDO
-	icon_loader_finish(server);
-#endif
 }
@@ -1,22 +1,58 @@
 // SPDX-License-Identifier: GPL-2.0-only
+#define _POSIX_C_SOURCE 200809L
 #include <assert.h>
+#include <string.h>
 #include <wlr/types/wlr_scene.h>
 #include <wlr/util/box.h>
 #include <wlr/util/log.h>
+#include "common/glyph-atlas.h"
 #include "common/macros.h"
-#include "common/scaled-font-buffer.h"
+#include "common/scaled-scene-buffer.h"
 #include "labwc.h"
 #include "resize-indicator.h"
 #include "resize-outlines.h"
 #include "view.h"
 
+/* Everything the indicator can show for sizes and positions */
+#define INDICATOR_GLYPHS "0123456789-x, "
+
+/*
+ * Glyphs are laid out once per font and theme rather than on every
+ * motion event. Dropped on reconfigure and re-created on next use.
+ */
+static struct glyph_atlas *atlas;
+
+static struct glyph_atlas *
+get_atlas(void)
+{
+	if (!atlas) {
+		atlas = glyph_atlas_create(INDICATOR_GLYPHS, &rc.font_osd,
+			rc.theme->osd_label_text_color, rc.theme->osd_bg_color);
+	}
+	return atlas;
+}
+
+static struct lab_data_buffer *
+create_text_buffer(struct scaled_scene_buffer *scaled_buffer, double scale)
+{
+	struct resize_indicator *indicator = scaled_buffer->data;
+	return glyph_atlas_render(get_atlas(), indicator->label, scale);
+}
+
+static const struct scaled_scene_buffer_impl text_impl = {
+	.create_buffer = create_text_buffer,
+};
+
 static void
 resize_indicator_reconfigure_view(struct resize_indicator *indicator)
 {
 	assert(indicator->tree);
 
+	/* Force the next update to render with the new atlas */
+	indicator->label[0] = '\0';
+
 	struct theme *theme = rc.theme;
-	indicator->height = font_height(&rc.font_osd)
+	indicator->height = glyph_atlas_height(get_atlas())
 		+ 2 * theme->osd_window_switcher_padding
 		+ 2 * theme->osd_border_width;
 
@@ -45,7 +81,9 @@ resize_indicator_init(struct view *view)
 		indicator->tree, 0, 0, rc.theme->osd_border_color);
 	indicator->background = wlr_scene_rect_create(
 		indicator->tree, 0, 0, rc.theme->osd_bg_color);
-	indicator->text = scaled_font_buffer_create(indicator->tree);
+	indicator->text = scaled_scene_buffer_create(indicator->tree,
+		&text_impl, /* drop_buffer */ true);
+	indicator->text->data = indicator;
 
 	wlr_scene_node_set_enabled(&indicator->tree->node, false);
 	resize_indicator_reconfigure_view(indicator);
@@ -71,6 +109,9 @@ wants_indicator(struct view *view)
 void
 resize_indicator_reconfigure(struct server *server)
 {
+	glyph_atlas_destroy(atlas);
+	atlas = NULL;
+
 	struct view *view;
 	wl_list_for_each(view, &server->views, link) {
 		struct resize_indicator *indicator = &view->resize_indicator;
@@ -98,6 +139,34 @@ resize_indicator_reconfigure(struct server *server)
 	}
 }
 
+/* Format "<a><separator><b>" without going through snprintf() */
+static void
+format_pair(char *buf, int a, const char *separator, int b)
+{
+	char digits[12];
+	int values[] = { a, b };
+
+	for (size_t i = 0; i < ARRAY_SIZE(values); i++) {
+		if (i > 0) {
+			buf = stpcpy(buf, separator);
+		}
+		unsigned int value = values[i] < 0
+			? -(unsigned int)values[i] : (unsigned int)values[i];
+		if (values[i] < 0) {
+			*buf++ = '-';
+		}
+		char *p = digits + sizeof(digits);
+		do {
+			*--p = '0' + value % 10;
+			value /= 10;
+		} while (value);
+		size_t len = digits + sizeof(digits) - p;
+		memcpy(buf, p, len);
+		buf += len;
+	}
+	*buf = '\0';
+}
+
 static void
 resize_indicator_set_size(struct resize_indicator *indicator, int width)
 {
@@ -158,7 +227,7 @@ resize_indicator_update(struct view *view)
 		resize_indicator_show(view);
 	}
 
-	char text[32]; /* 12345 x 12345 would be 13 chars + 1 null byte */
+	char text[sizeof(indicator->label)];
 
 	struct wlr_box view_box;
 	if (resize_outlines_enabled(view)) {
@@ -172,18 +241,16 @@ resize_indicator_update(struct view *view)
 	case LAB_INPUT_STATE_RESIZE:
 		; /* works around "a label can only be part of a statement" */
 		struct view_size_hints hints = view_get_size_hints(view);
-		snprintf(text, sizeof(text), "%d x %d",
-			MAX(0, view_box.width - hints.base_width)
+		format_pair(text, MAX(0, view_box.width - hints.base_width)
 				/ MAX(1, hints.width_inc),
-			MAX(0, view_box.height - hints.base_height)
+			" x ", MAX(0, view_box.height - hints.base_height)
 				/ MAX(1, hints.height_inc));
 		break;
 	case LAB_INPUT_STATE_MOVE:
 		; /* works around "a label can only be part of a statement" */
 		struct border margin = ssd_get_margin(view->ssd);
-		snprintf(text, sizeof(text), "%d , %d",
-			view_box.x - margin.left,
-			view_box.y - margin.top);
+		format_pair(text, view_box.x - margin.left,
+			" , ", view_box.y - margin.top);
 		break;
 	default:
 		wlr_log(WLR_ERROR, "Invalid input mode for indicator update %u",
@@ -192,11 +259,7 @@ resize_indicator_update(struct view *view)
 	}
 
 	/* Let the indicator change width as required by the content */
-	int width = font_width(&rc.font_osd, text);
-
-	/* font_extents() adds 4 pixels to the calculated width */
-	width -= 4;
-
+	int width = glyph_atlas_text_width(get_atlas(), text);
 	resize_indicator_set_size(indicator, width);
 
 	/* Center the indicator in the window */
@@ -204,9 +267,11 @@ resize_indicator_update(struct view *view)
 	int y = view_box.y - view->current.y + (view_box.height - indicator->height) / 2;
 	wlr_scene_node_set_position(&indicator->tree->node, x, y);
 
-	scaled_font_buffer_update(indicator->text, text, width, &rc.font_osd,
-		rc.theme->osd_label_text_color, rc.theme->osd_bg_color,
-		NULL /* const char *arrow */);
+	/* Moving without crossing a size increment does not change the text */
+	if (strcmp(text, indicator->label)) {
+		memcpy(indicator->label, text, sizeof(indicator->label));
+		scaled_scene_buffer_invalidate_cache(indicator->text);
+	}
 }
 
 void
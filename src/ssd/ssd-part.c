@@ -5,9 +5,11 @@
 #include "common/box.h"
 #include "common/list.h"
 #include "common/mem.h"
+#include "common/scaled-scene-buffer.h"
 #include "labwc.h"
 #include "node.h"
 #include "ssd-internal.h"
+#include "theme.h"
 
 /* Internal helpers */
 static void
@@ -38,6 +40,55 @@ ssd_button_descriptor_create(struct wlr_scene_node *node)
 	return button;
 }
 
+struct button_icon {
+	int active;
+	enum ssd_part_type type;
+	uint8_t state_set;
+};
+
+static struct lab_data_buffer *
+button_icon_create_buffer(struct scaled_scene_buffer *scaled_buffer,
+		double scale)
+{
+	struct button_icon *icon = scaled_buffer->data;
+	return theme_get_button(rc.theme, icon->active, icon->type,
+		icon->state_set, scale);
+}
+
+static void
+button_icon_destroy(struct scaled_scene_buffer *scaled_buffer)
+{
+	free(scaled_buffer->data);
+}
+
+static const struct scaled_scene_buffer_impl button_icon_impl = {
+	.create_buffer = button_icon_create_buffer,
+	.destroy = button_icon_destroy,
+};
+
+/*
+ * Add a theme button icon which is rendered again by the theme when shown
+ * on an output with a different scale. The buffers are owned by the theme.
+ */
+static struct scaled_scene_buffer *
+add_scene_button_icon(struct wl_list *part_list, enum ssd_part_type type,
+		struct wlr_scene_tree *parent, int active, uint8_t state_set)
+{
+	struct scaled_scene_buffer *scaled_buffer = scaled_scene_buffer_create(
+		parent, &button_icon_impl, /* drop_buffer */ false);
+	struct button_icon *icon = znew(*icon);
+	icon->active = active;
+	icon->type = type;
+	icon->state_set = state_set;
+	scaled_buffer->data = icon;
+	/* Set the buffer for scale 1 until the node enters an output */
+	scaled_scene_buffer_invalidate_cache(scaled_buffer);
+
+	struct ssd_part *part = add_scene_part(part_list, type);
+	part->node = &scaled_buffer->scene_buffer->node;
+	return scaled_buffer;
+}
+
 /* Internal API */
 struct ssd_part *
 add_scene_part(struct wl_list *part_list, enum ssd_part_type type)
@@ -107,10 +158,11 @@ update_window_icon_buffer(struct wlr_scene_node *button_node,
 
 struct ssd_part *
 add_scene_button(struct wl_list *part_list, enum ssd_part_type type,
-		struct wlr_scene_tree *parent,
-		struct lab_data_buffer *buffers[LAB_BS_ALL + 1],
-		int x, int y, struct view *view)
+		struct wlr_scene_tree *parent, int active, int x, int y,
+		struct view *view)
 {
+	struct lab_data_buffer **buffers =
+		rc.theme->window[active].buttons[type];
 	struct ssd_part *button_root = add_scene_part(part_list, type);
 	parent = wlr_scene_tree_create(parent);
 	button_root->node = &parent->node;
@@ -124,6 +176,7 @@ add_scene_button(struct wl_list *part_list, enum ssd_part_type type,
 
 	/* Icons */
 	struct wlr_scene_node *nodes[LAB_BS_ALL + 1] = {0};
+	struct scaled_scene_buffer *icons[LAB_BS_ALL + 1] = {0};
 	for (uint8_t state_set = 0; state_set <= LAB_BS_ALL; state_set++) {
 		if (!buffers[state_set]) {
 			continue;
@@ -131,14 +184,24 @@ add_scene_button(struct wl_list *part_list, enum ssd_part_type type,
 		struct lab_data_buffer *icon_buffer = buffers[state_set];
 		struct wlr_box icon_geo = get_scale_box(icon_buffer,
 			rc.theme->window_button_width, rc.theme->window_button_height);
-		struct ssd_part *icon_part = add_scene_buffer(part_list, type,
-			parent, &icon_buffer->base, icon_geo.x, icon_geo.y);
-		/* Make sure big icons are scaled down if necessary */
-		wlr_scene_buffer_set_dest_size(
-			wlr_scene_buffer_from_node(icon_part->node),
-			icon_geo.width, icon_geo.height);
-		wlr_scene_node_set_enabled(icon_part->node, false);
-		nodes[state_set] = icon_part->node;
+		struct wlr_scene_node *icon_node;
+		if (type == LAB_SSD_BUTTON_WINDOW_ICON) {
+			/* Replaced by the app icon once it has been loaded */
+			icon_node = add_scene_buffer(part_list, type, parent,
+				&icon_buffer->base, icon_geo.x, icon_geo.y)->node;
+			/* Make sure big icons are scaled down if necessary */
+			wlr_scene_buffer_set_dest_size(
+				wlr_scene_buffer_from_node(icon_node),
+				icon_geo.width, icon_geo.height);
+		} else {
+			icons[state_set] = add_scene_button_icon(part_list,
+				type, parent, active, state_set);
+			icon_node = &icons[state_set]->scene_buffer->node;
+			wlr_scene_node_set_position(icon_node,
+				icon_geo.x, icon_geo.y);
+		}
+		wlr_scene_node_set_enabled(icon_node, false);
+		nodes[state_set] = icon_node;
 	}
 	/* Initially show non-hover, non-toggled, unrounded variant */
 	wlr_scene_node_set_enabled(nodes[0], true);
@@ -148,9 +211,70 @@ add_scene_button(struct wl_list *part_list, enum ssd_part_type type,
 	button->view = view;
 	button->state_set = 0;
 	memcpy(button->nodes, nodes, sizeof(nodes));
+	memcpy(button->icons, icons, sizeof(icons));
 	return button_root;
 }
 
+/*
+ * Check that a button created by add_scene_button() has an icon node for
+ * exactly those states the current theme has buttons for.
+ */
+bool
+scene_button_matches_theme(struct ssd_part *button_root, int active)
+{
+	struct ssd_button *button = node_ssd_button_from_node(button_root->node);
+	struct lab_data_buffer **buffers =
+		rc.theme->window[active].buttons[button->type];
+	for (uint8_t state_set = 0; state_set <= LAB_BS_ALL; state_set++) {
+		if (!button->nodes[state_set] != !buffers[state_set]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/*
+ * Make a button created by add_scene_button() use the buffers and sizes
+ * of the current theme. Must only be used if scene_button_matches_theme().
+ */
+void
+update_scene_button(struct ssd_part *button_root, int active)
+{
+	struct ssd_button *button = node_ssd_button_from_node(button_root->node);
+	struct lab_data_buffer **buffers =
+		rc.theme->window[active].buttons[button->type];
+	int width = rc.theme->window_button_width;
+	int height = rc.theme->window_button_height;
+
+	/* Hitbox */
+	struct wlr_scene_tree *tree = wlr_scene_tree_from_node(button_root->node);
+	struct wlr_scene_node *child;
+	wl_list_for_each(child, &tree->children, link) {
+		if (child->type == WLR_SCENE_NODE_RECT) {
+			wlr_scene_rect_set_size(wlr_scene_rect_from_node(child),
+				width, height);
+		}
+	}
+
+	/* Icons */
+	for (uint8_t state_set = 0; state_set <= LAB_BS_ALL; state_set++) {
+		if (!button->nodes[state_set]) {
+			continue;
+		}
+		if (!button->icons[state_set]) {
+			/* Window icon fallback, replaced by the app icon again */
+			update_window_icon_buffer(button->nodes[state_set],
+				buffers[state_set]);
+			continue;
+		}
+		struct wlr_box icon_geo = get_scale_box(buffers[state_set],
+			width, height);
+		scaled_scene_buffer_invalidate_cache(button->icons[state_set]);
+		wlr_scene_node_set_position(button->nodes[state_set],
+			icon_geo.x, icon_geo.y);
+	}
+}
+
 struct ssd_part *
 ssd_get_part(struct wl_list *part_list, enum ssd_part_type type)
 {
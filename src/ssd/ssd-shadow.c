@@ -309,6 +309,74 @@ ssd_shadow_update(struct ssd *ssd)
 	}
 }
 
+bool
+ssd_shadow_can_apply_theme(struct ssd *ssd)
+{
+	struct theme *theme = ssd->view->server->theme;
+	struct ssd_sub_tree *subtree;
+	FOR_EACH_STATE(ssd, subtree) {
+		int size = subtree == &ssd->shadow.active
+			? theme->window_active_shadow_size
+			: theme->window_inactive_shadow_size;
+		bool enabled = rc.shadows_enabled && size != 0;
+		if (enabled != !!subtree->tree) {
+			return false;
+		}
+	} FOR_EACH_END
+	return true;
+}
+
+void
+ssd_shadow_apply_theme(struct ssd *ssd)
+{
+	assert(ssd);
+	assert(ssd->shadow.tree);
+
+	struct theme *theme = ssd->view->server->theme;
+	struct wlr_buffer *corner_top_buffer;
+	struct wlr_buffer *corner_bottom_buffer;
+	struct wlr_buffer *edge_buffer;
+	struct ssd_part *part;
+	struct ssd_sub_tree *subtree;
+
+	FOR_EACH_STATE(ssd, subtree) {
+		if (!subtree->tree) {
+			continue;
+		}
+		if (subtree == &ssd->shadow.active) {
+			corner_top_buffer = &theme->shadow_corner_top_active->base;
+			corner_bottom_buffer = &theme->shadow_corner_bottom_active->base;
+			edge_buffer = &theme->shadow_edge_active->base;
+		} else {
+			corner_top_buffer = &theme->shadow_corner_top_inactive->base;
+			corner_bottom_buffer = &theme->shadow_corner_bottom_inactive->base;
+			edge_buffer = &theme->shadow_edge_inactive->base;
+		}
+
+		wl_list_for_each(part, &subtree->parts, link) {
+			struct wlr_buffer *buf;
+			switch (part->type) {
+			case LAB_SSD_PART_CORNER_BOTTOM_RIGHT:
+			case LAB_SSD_PART_CORNER_BOTTOM_LEFT:
+				buf = corner_bottom_buffer;
+				break;
+			case LAB_SSD_PART_CORNER_TOP_LEFT:
+			case LAB_SSD_PART_CORNER_TOP_RIGHT:
+				buf = corner_top_buffer;
+				break;
+			default:
+				buf = edge_buffer;
+				break;
+			}
+			wlr_scene_buffer_set_buffer(
+				wlr_scene_buffer_from_node(part->node), buf);
+		}
+	} FOR_EACH_END
+
+	/* The shadow sizes may have changed */
+	ssd_shadow_update(ssd);
+}
+
 void
 ssd_shadow_destroy(struct ssd *ssd)
 {
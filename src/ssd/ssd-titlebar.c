@@ -25,6 +25,7 @@
 static void set_squared_corners(struct ssd *ssd, bool enable);
 static void set_alt_button_icon(struct ssd *ssd, enum ssd_part_type type, bool enable);
 static void update_visible_buttons(struct ssd *ssd);
+static void update_layout(struct ssd *ssd);
 
 void
 ssd_titlebar_create(struct ssd *ssd)
@@ -80,20 +81,16 @@ ssd_titlebar_create(struct ssd *ssd)
 		int y = (theme->title_height - theme->window_button_height) / 2;
 
 		wl_list_for_each(b, &rc.title_buttons_left, link) {
-			struct lab_data_buffer **buffers =
-				theme->window[active].buttons[b->type];
 			add_scene_button(&subtree->parts, b->type, parent,
-				buffers, x, y, view);
+				active, x, y, view);
 			x += theme->window_button_width + theme->window_button_spacing;
 		}
 
 		x = width - theme->window_titlebar_padding_width + theme->window_button_spacing;
 		wl_list_for_each_reverse(b, &rc.title_buttons_right, link) {
 			x -= theme->window_button_width + theme->window_button_spacing;
-			struct lab_data_buffer **buffers =
-				theme->window[active].buttons[b->type];
 			add_scene_button(&subtree->parts, b->type, parent,
-				buffers, x, y, view);
+				active, x, y, view);
 		}
 	} FOR_EACH_END
 
@@ -264,8 +261,6 @@ ssd_titlebar_update(struct ssd *ssd)
 {
 	struct view *view = ssd->view;
 	int width = view->current.width;
-	int corner_width = ssd_get_corner_width();
-	struct theme *theme = view->server->theme;
 
 	bool maximized = view->maximized == VIEW_AXIS_BOTH;
 	bool squared = ssd_should_be_squared(ssd);
@@ -295,6 +290,20 @@ ssd_titlebar_update(struct ssd *ssd)
 		return;
 	}
 
+	update_layout(ssd);
+	ssd_update_title(ssd);
+	ssd_update_window_icon(ssd);
+}
+
+/* Size the background and position the buttons for the view width */
+static void
+update_layout(struct ssd *ssd)
+{
+	struct view *view = ssd->view;
+	int width = view->current.width;
+	int corner_width = ssd_get_corner_width();
+	struct theme *theme = view->server->theme;
+
 	update_visible_buttons(ssd);
 
 	/* Center buttons vertically within titlebar */
@@ -303,7 +312,8 @@ ssd_titlebar_update(struct ssd *ssd)
 	struct ssd_part *part;
 	struct ssd_sub_tree *subtree;
 	struct title_button *b;
-	int bg_offset = maximized || squared ? 0 : corner_width;
+	int bg_offset = ssd->state.was_maximized || ssd->state.was_squared
+		? 0 : corner_width;
 	FOR_EACH_STATE(ssd, subtree) {
 		part = ssd_get_part(&subtree->parts, LAB_SSD_PART_TITLEBAR);
 		wlr_scene_rect_set_size(
@@ -328,8 +338,119 @@ ssd_titlebar_update(struct ssd *ssd)
 			wlr_scene_node_set_position(part->node, x, y);
 		}
 	} FOR_EACH_END
+}
+
+static bool
+is_button_root(struct ssd_part *part)
+{
+	return part->type >= LAB_SSD_BUTTON_FIRST
+		&& part->type <= LAB_SSD_BUTTON_LAST
+		&& part->node->type == WLR_SCENE_NODE_TREE;
+}
+
+bool
+ssd_titlebar_can_apply_theme(struct ssd *ssd)
+{
+	int button_count = wl_list_length(&rc.title_buttons_left)
+		+ wl_list_length(&rc.title_buttons_right);
+
+	struct ssd_part *part;
+	struct ssd_sub_tree *subtree;
+	struct title_button *b;
+	FOR_EACH_STATE(ssd, subtree) {
+		int active = (subtree == &ssd->titlebar.active) ?
+				THEME_ACTIVE : THEME_INACTIVE;
+
+		/* The buttons must still be those of the titlebar layout */
+		int count = 0;
+		wl_list_for_each(part, &subtree->parts, link) {
+			count += is_button_root(part);
+		}
+		if (count != button_count) {
+			return false;
+		}
+		/* A title which is no longer wanted would be left behind */
+		if (!rc.show_title && ssd_get_part(&subtree->parts,
+				LAB_SSD_PART_TITLE)) {
+			return false;
+		}
+		wl_list_for_each(b, &rc.title_buttons_left, link) {
+			part = ssd_get_part(&subtree->parts, b->type);
+			if (!part || !scene_button_matches_theme(part, active)) {
+				return false;
+			}
+		}
+		wl_list_for_each(b, &rc.title_buttons_right, link) {
+			part = ssd_get_part(&subtree->parts, b->type);
+			if (!part || !scene_button_matches_theme(part, active)) {
+				return false;
+			}
+		}
+	} FOR_EACH_END
+	return true;
+}
+
+void
+ssd_titlebar_apply_theme(struct ssd *ssd)
+{
+	struct view *view = ssd->view;
+	struct theme *theme = view->server->theme;
+
+	float *color;
+	struct wlr_buffer *corner_top_left;
+	struct wlr_buffer *corner_top_right;
+	struct ssd_part *part;
+	struct ssd_sub_tree *subtree;
+	FOR_EACH_STATE(ssd, subtree) {
+		int active;
+		wlr_scene_node_set_position(&subtree->tree->node,
+			0, -theme->title_height);
+		if (subtree == &ssd->titlebar.active) {
+			active = THEME_ACTIVE;
+			color = theme->window_active_title_bg_color;
+			corner_top_left = &theme->corner_top_left_active_normal->base;
+			corner_top_right = &theme->corner_top_right_active_normal->base;
+		} else {
+			active = THEME_INACTIVE;
+			color = theme->window_inactive_title_bg_color;
+			corner_top_left = &theme->corner_top_left_inactive_normal->base;
+			corner_top_right = &theme->corner_top_right_inactive_normal->base;
+		}
+
+		part = ssd_get_part(&subtree->parts, LAB_SSD_PART_TITLEBAR);
+		wlr_scene_rect_set_color(wlr_scene_rect_from_node(part->node),
+			color);
+
+		part = ssd_get_part(&subtree->parts, LAB_SSD_PART_TITLEBAR_CORNER_LEFT);
+		wlr_scene_buffer_set_buffer(wlr_scene_buffer_from_node(part->node),
+			corner_top_left);
+		wlr_scene_node_set_position(part->node,
+			-theme->border_width, -theme->border_width);
 
+		part = ssd_get_part(&subtree->parts, LAB_SSD_PART_TITLEBAR_CORNER_RIGHT);
+		wlr_scene_buffer_set_buffer(wlr_scene_buffer_from_node(part->node),
+			corner_top_right);
+
+		wl_list_for_each(part, &subtree->parts, link) {
+			if (is_button_root(part)) {
+				update_scene_button(part, active);
+			}
+		}
+	} FOR_EACH_END
+
+	/* The corner width may have changed with the corner radius */
+	bool maximized = view->maximized == VIEW_AXIS_BOTH;
+	bool squared = ssd_should_be_squared(ssd);
+	ssd->state.was_squared = squared;
+	update_layout(ssd);
+	set_squared_corners(ssd, maximized || squared);
+
+	/* Render the title again with the new font and colors */
+	zfree(ssd->state.title.text);
 	ssd_update_title(ssd);
+
+	/* And look up the window icon again for the new button size */
+	zfree(ssd->state.app_id);
 	ssd_update_window_icon(ssd);
 }
 
@@ -353,6 +474,13 @@ ssd_titlebar_destroy(struct ssd *ssd)
 	if (ssd->state.app_id) {
 		zfree(ssd->state.app_id);
 	}
+#if HAVE_LIBSFDO
+	if (ssd->titlebar.icon_request) {
+		icon_request_cancel(ssd->view->server,
+			ssd->titlebar.icon_request);
+		ssd->titlebar.icon_request = NULL;
+	}
+#endif
 
 	wlr_scene_node_destroy(&ssd->titlebar.tree->node);
 	ssd->titlebar.tree = NULL;
@@ -578,6 +706,39 @@ ssd_should_be_squared(struct ssd *ssd)
 		&& view->maximized != VIEW_AXIS_BOTH;
 }
 
+#if HAVE_LIBSFDO
+static void
+handle_window_icon_loaded(struct lab_data_buffer *icon_buffer, void *data)
+{
+	struct ssd *ssd = data;
+	ssd->titlebar.icon_request = NULL;
+
+	if (!icon_buffer) {
+		wlr_log(WLR_DEBUG, "icon could not be loaded for %s",
+			ssd->state.app_id);
+		return;
+	}
+
+	struct ssd_sub_tree *subtree;
+	FOR_EACH_STATE(ssd, subtree) {
+		struct ssd_part *part = ssd_get_part(
+			&subtree->parts, LAB_SSD_BUTTON_WINDOW_ICON);
+		if (!part) {
+			break;
+		}
+
+		/* Replace all the buffers in the button with the window icon */
+		struct ssd_button *button = node_ssd_button_from_node(part->node);
+		for (uint8_t state_set = 0; state_set <= LAB_BS_ALL; state_set++) {
+			if (button->nodes[state_set]) {
+				update_window_icon_buffer(button->nodes[state_set],
+					icon_buffer);
+			}
+		}
+	} FOR_EACH_END
+}
+#endif
+
 void
 ssd_update_window_icon(struct ssd *ssd)
 {
@@ -597,7 +758,8 @@ ssd_update_window_icon(struct ssd *ssd)
 	free(ssd->state.app_id);
 	ssd->state.app_id = xstrdup(app_id);
 
-	struct theme *theme = ssd->view->server->theme;
+	struct server *server = ssd->view->server;
+	struct theme *theme = server->theme;
 
 	/*
 	 * Ensure a small amount of horizontal padding within the button
@@ -619,34 +781,18 @@ ssd_update_window_icon(struct ssd *ssd)
 	 * TODO: currently there's no signal to reload/render icons if
 	 * outputs are reconfigured and the max scale changes.
 	 */
-	float icon_scale = output_max_scale(ssd->view->server);
+	float icon_scale = output_max_scale(server);
 
-	struct lab_data_buffer *icon_buffer = icon_loader_lookup(
-		ssd->view->server, app_id, icon_size, icon_scale);
-	if (!icon_buffer) {
-		wlr_log(WLR_DEBUG, "icon could not be loaded for %s", app_id);
-		return;
+	/*
+	 * Icon lookup involves file I/O and image decoding, so it is done
+	 * off the compositor thread. The titlebar keeps showing the
+	 * theme's fallback icon until the app icon has been loaded.
+	 */
+	if (ssd->titlebar.icon_request) {
+		icon_request_cancel(server, ssd->titlebar.icon_request);
 	}
-
-	struct ssd_sub_tree *subtree;
-	FOR_EACH_STATE(ssd, subtree) {
-		struct ssd_part *part = ssd_get_part(
-			&subtree->parts, LAB_SSD_BUTTON_WINDOW_ICON);
-		if (!part) {
-			break;
-		}
-
-		/* Replace all the buffers in the button with the window icon */
-		struct ssd_button *button = node_ssd_button_from_node(part->node);
-		for (uint8_t state_set = 0; state_set <= LAB_BS_ALL; state_set++) {
-			if (button->nodes[state_set]) {
-				update_window_icon_buffer(button->nodes[state_set],
-					icon_buffer);
-			}
-		}
-	} FOR_EACH_END
-
-	wlr_buffer_drop(&icon_buffer->base);
+	ssd->titlebar.icon_request = icon_loader_request(server, app_id,
+		icon_size, icon_scale, handle_window_icon_loaded, ssd);
 #endif
 }
 
@@ -177,6 +177,8 @@ ssd_create(struct view *view, bool active)
 	ssd->tree = wlr_scene_tree_create(view->scene_tree);
 	wlr_scene_node_lower_to_bottom(&ssd->tree->node);
 	ssd->titlebar.height = view->server->theme->title_height;
+	ssd->state.border_width = view->server->theme->border_width;
+	ssd->state.corner_width = ssd_get_corner_width();
 	ssd_shadow_create(ssd);
 	ssd_extents_create(ssd);
 	/*
@@ -209,7 +211,7 @@ int
 ssd_get_corner_width(void)
 {
 	/* ensure a minimum corner width */
-	return MAX(rc.corner_radius, 5);
+	return MAX(rc.theme->corner_radius, 5);
 }
 
 void
@@ -278,6 +280,45 @@ ssd_set_titlebar(struct ssd *ssd, bool enabled)
 	ssd->margin = ssd_thickness(ssd->view);
 }
 
+bool
+ssd_apply_theme(struct ssd *ssd)
+{
+	if (!ssd) {
+		return false;
+	}
+
+	/*
+	 * Changes to the titlebar layout or to which shadows are shown
+	 * need a different set of scene nodes
+	 */
+	if (!ssd_titlebar_can_apply_theme(ssd)
+			|| !ssd_shadow_can_apply_theme(ssd)) {
+		return false;
+	}
+
+	struct view *view = ssd->view;
+	struct theme *theme = view->server->theme;
+	int titlebar_height = ssd->titlebar.tree->node.enabled
+		? theme->title_height : 0;
+	bool relayout = ssd->titlebar.height != titlebar_height
+		|| ssd->state.border_width != theme->border_width
+		|| ssd->state.corner_width != ssd_get_corner_width();
+	ssd->titlebar.height = titlebar_height;
+	ssd->state.border_width = theme->border_width;
+	ssd->state.corner_width = ssd_get_corner_width();
+
+	ssd_titlebar_apply_theme(ssd);
+	ssd_border_apply_theme(ssd);
+	ssd_enable_keybind_inhibit_indicator(ssd, view->inhibits_keybinds);
+	ssd_shadow_apply_theme(ssd);
+	if (relayout) {
+		ssd_border_update(ssd);
+		ssd_extents_update(ssd);
+		ssd->margin = ssd_thickness(view);
+	}
+	return true;
+}
+
 void
 ssd_destroy(struct ssd *ssd)
 {
@@ -9,6 +9,7 @@
 #include "config.h"
 #include <assert.h>
 #include <cairo.h>
+#include <dirent.h>
 #include <drm_fourcc.h>
 #include <glib.h>
 #include <stdbool.h>
@@ -19,6 +20,8 @@
 #include <wlr/util/log.h>
 #include <wlr/render/pixman.h>
 #include <strings.h>
+#include "common/box.h"
+#include "common/buf.h"
 #include "common/macros.h"
 #include "common/dir.h"
 #include "common/font.h"
@@ -113,9 +116,20 @@ copy_icon_buffer(struct theme *theme, struct lab_data_buffer *icon_buffer)
 		buffer_width, buffer_height, 1.0);
 	cairo_t *cairo = buffer->cairo;
 
+	/*
+	 * Buffers rendered for an output scale carry a cairo device scale.
+	 * Copy them pixel by pixel, the scaling is done by the cairo_scale()
+	 * below and by wlroots.
+	 */
+	double device_scale_x, device_scale_y;
+	cairo_surface_get_device_scale(icon.surface,
+		&device_scale_x, &device_scale_y);
+	cairo_surface_set_device_scale(icon.surface, 1, 1);
 	cairo_set_source_surface(cairo, icon.surface,
 		(buffer_width - icon_width) / 2, (buffer_height - icon_height) / 2);
 	cairo_paint(cairo);
+	cairo_surface_set_device_scale(icon.surface,
+		device_scale_x, device_scale_y);
 
 	/*
 	 * Scale cairo context so that we can draw hover overlay or rounded
@@ -186,7 +200,7 @@ create_rounded_buffer(struct theme *theme, enum corner corner,
 			.width = margin_x + width,
 			.height = margin_y + height,
 		},
-		.radius = rc.corner_radius,
+		.radius = theme->corner_radius,
 		.line_width = theme->border_width,
 		.fill_color = white,
 		.border_color = white,
@@ -204,66 +218,122 @@ create_rounded_buffer(struct theme *theme, enum corner corner,
 }
 
 /*
- * Scan theme directories with button names (name + postfix) and write the full
- * path of the found button file to @buf. An empty string is set if a button
- * file is not found.
+ * List the files in the theme directories once, mapping each filename to
+ * the full path of its first occurrence. This lets buttons be looked up
+ * without probing every directory for every candidate filename.
  */
-static void
-get_button_filename(char *buf, size_t len, const char *name, const char *postfix)
+static GHashTable *
+scan_theme_dirs(const char *theme_name)
 {
-	buf[0] = '\0';
-
-	char filename[4096];
-	snprintf(filename, sizeof(filename), "%s%s", name, postfix);
+	GHashTable *files = g_hash_table_new_full(g_str_hash, g_str_equal,
+		g_free, g_free);
 
 	struct wl_list paths;
-	paths_theme_create(&paths, rc.theme_name, filename);
+	paths_theme_create(&paths, theme_name, "");
 
 	/*
 	 * You can't really merge buttons, so let's just iterate forwards
-	 * and stop on the first hit
+	 * and keep the first hit
 	 */
 	struct path *path;
 	wl_list_for_each(path, &paths, link) {
-		if (access(path->string, R_OK) == 0) {
-			snprintf(buf, len, "%s", path->string);
-			break;
+		DIR *dir = opendir(path->string);
+		if (!dir) {
+			continue;
 		}
+		struct dirent *entry;
+		while ((entry = readdir(dir))) {
+			if (entry->d_name[0] == '.' || g_hash_table_contains(
+					files, entry->d_name)) {
+				continue;
+			}
+			g_hash_table_insert(files, g_strdup(entry->d_name),
+				g_strdup_printf("%s%s", path->string,
+					entry->d_name));
+		}
+		closedir(dir);
 	}
 	paths_destroy(&paths);
+	return files;
+}
+
+/*
+ * Look up button names (name + postfix) in the theme files and write the
+ * full path of the found button file to @buf. An empty string is set if a
+ * button file is not found.
+ */
+static void
+get_button_filename(GHashTable *theme_files, char *buf, size_t len,
+		const char *name, const char *postfix)
+{
+	buf[0] = '\0';
+
+	char filename[4096];
+	snprintf(filename, sizeof(filename), "%s%s", name, postfix);
+
+	const char *path = g_hash_table_lookup(theme_files, filename);
+	if (path) {
+		snprintf(buf, len, "%s", path);
+	}
+}
+
+/*
+ * Set the logical size of a button texture to the size it is displayed
+ * at, which is the same for all scales.
+ */
+static void
+fit_button_logical_size(struct theme *theme, struct lab_data_buffer *buffer)
+{
+	if (!buffer) {
+		return;
+	}
+	struct wlr_box box = box_fit_within(buffer->logical_width,
+		buffer->logical_height, theme->window_button_width,
+		theme->window_button_height);
+	buffer->logical_width = box.width;
+	buffer->logical_height = box.height;
 }
 
 static void
-load_button(struct theme *theme, struct button *b, int active)
+load_button(struct theme *theme, GHashTable *theme_files, struct button *b,
+		int active)
 {
 	struct lab_data_buffer *(*buttons)[LAB_BS_ALL + 1] =
 		theme->window[active].buttons;
 	struct lab_data_buffer **buffer = &buttons[b->type][b->state_set];
+	struct theme_button_source *source =
+		&theme->window[active].button_sources[b->type][b->state_set];
 	float *rgba = theme->window[active].button_colors[b->type];
 	char filename[4096];
 
 	zdrop(buffer);
+	zfree(source->svg_filename);
+	source->hover_fallback = false;
 
 	int size = theme->window_button_height;
 	float scale = 1; /* TODO: account for output scale */
 
 	/* PNG */
-	get_button_filename(filename, sizeof(filename), b->name,
-		active ? "-active.png" : "-inactive.png");
+	get_button_filename(theme_files, filename, sizeof(filename),
+		b->name, active ? "-active.png" : "-inactive.png");
 	img_png_load(filename, buffer, size, scale);
 
 #if HAVE_RSVG
 	/* SVG */
 	if (!*buffer) {
-		get_button_filename(filename, sizeof(filename), b->name,
-			active ? "-active.svg" : "-inactive.svg");
+		get_button_filename(theme_files, filename, sizeof(filename),
+			b->name, active ? "-active.svg" : "-inactive.svg");
 		img_svg_load(filename, buffer, size, scale);
+		if (*buffer) {
+			source->svg_filename = xstrdup(filename);
+		}
 	}
 #endif
 
 	/* XBM */
 	if (!*buffer) {
-		get_button_filename(filename, sizeof(filename), b->name, ".xbm");
+		get_button_filename(theme_files, filename, sizeof(filename),
+			b->name, ".xbm");
 		img_xbm_load(filename, buffer, rgba);
 	}
 
@@ -272,7 +342,7 @@ load_button(struct theme *theme, struct button *b, int active)
 	 * For example max_hover_toggled instead of max_toggled_hover
 	 */
 	if (!*buffer && b->alt_name) {
-		get_button_filename(filename, sizeof(filename),
+		get_button_filename(theme_files, filename, sizeof(filename),
 			b->alt_name, ".xbm");
 		img_xbm_load(filename, buffer, rgba);
 	}
@@ -295,7 +365,9 @@ load_button(struct theme *theme, struct button *b, int active)
 		uint8_t non_hover_state_set = b->state_set & ~LAB_BS_HOVERD;
 		create_hover_fallback(theme, buffer,
 			buttons[b->type][non_hover_state_set]);
+		source->hover_fallback = true;
 	}
+	fit_button_logical_size(theme, *buffer);
 
 	/*
 	 * If the loaded button is at the corner of the titlebar, also create
@@ -321,6 +393,100 @@ load_button(struct theme *theme, struct button *b, int active)
 		}
 		break;
 	}
+	fit_button_logical_size(theme, buttons[b->type][rounded_state_set]);
+}
+
+struct scaled_button {
+	int active;
+	enum ssd_part_type type;
+	uint8_t state_set;
+	double scale;
+	struct lab_data_buffer *buffer;
+	struct wl_list link; /* theme.scaled_buttons */
+};
+
+/* Same corner as chosen by load_button() */
+static enum corner
+get_rounded_corner(enum ssd_part_type type)
+{
+	struct title_button *rightmost_button;
+	wl_list_for_each_reverse(rightmost_button,
+			&rc.title_buttons_right, link) {
+		if (rightmost_button->type == type) {
+			return LAB_CORNER_TOP_RIGHT;
+		}
+		break;
+	}
+	return LAB_CORNER_TOP_LEFT;
+}
+
+static bool
+button_is_scalable(struct theme *theme, int active, enum ssd_part_type type,
+		uint8_t state_set)
+{
+	if (state_set & LAB_BS_ROUNDED) {
+		return button_is_scalable(theme, active, type,
+			state_set & ~LAB_BS_ROUNDED);
+	}
+	struct theme_button_source *source =
+		&theme->window[active].button_sources[type][state_set];
+	if (source->hover_fallback) {
+		return button_is_scalable(theme, active, type,
+			state_set & ~LAB_BS_HOVERD);
+	}
+	return source->svg_filename;
+}
+
+struct lab_data_buffer *
+theme_get_button(struct theme *theme, int active, enum ssd_part_type type,
+		uint8_t state_set, double scale)
+{
+	struct lab_data_buffer *unscaled =
+		theme->window[active].buttons[type][state_set];
+	if (!unscaled || scale <= 1
+			|| !button_is_scalable(theme, active, type, state_set)) {
+		return unscaled;
+	}
+
+	struct scaled_button *scaled;
+	wl_list_for_each(scaled, &theme->scaled_buttons, link) {
+		if (scaled->active == active && scaled->type == type
+				&& scaled->state_set == state_set
+				&& scaled->scale == scale) {
+			return scaled->buffer;
+		}
+	}
+
+	struct lab_data_buffer *buffer = NULL;
+	struct theme_button_source *source =
+		&theme->window[active].button_sources[type][state_set];
+	if (state_set & LAB_BS_ROUNDED) {
+		create_rounded_buffer(theme, get_rounded_corner(type), &buffer,
+			theme_get_button(theme, active, type,
+				state_set & ~LAB_BS_ROUNDED, scale));
+	} else if (source->hover_fallback) {
+		create_hover_fallback(theme, &buffer,
+			theme_get_button(theme, active, type,
+				state_set & ~LAB_BS_HOVERD, scale));
+	} else {
+#if HAVE_RSVG
+		img_svg_load(source->svg_filename, &buffer,
+			theme->window_button_height, scale);
+#endif
+	}
+	if (!buffer) {
+		return unscaled;
+	}
+	fit_button_logical_size(theme, buffer);
+
+	scaled = znew(*scaled);
+	scaled->active = active;
+	scaled->type = type;
+	scaled->state_set = state_set;
+	scaled->scale = scale;
+	scaled->buffer = buffer;
+	wl_list_insert(&theme->scaled_buttons, &scaled->link);
+	return buffer;
 }
 
 /*
@@ -463,11 +629,13 @@ load_buttons(struct theme *theme)
 		/* no fallback (non-hover variant is used instead) */
 	}, };
 
+	GHashTable *theme_files = scan_theme_dirs(rc.theme_name);
 	for (size_t i = 0; i < ARRAY_SIZE(buttons); ++i) {
 		struct button *b = &buttons[i];
-		load_button(theme, b, THEME_INACTIVE);
-		load_button(theme, b, THEME_ACTIVE);
+		load_button(theme, theme_files, b, THEME_INACTIVE);
+		load_button(theme, theme_files, b, THEME_ACTIVE);
 	}
+	g_hash_table_destroy(theme_files);
 }
 
 static int
@@ -1251,7 +1419,7 @@ create_corners(struct theme *theme)
 
 	struct rounded_corner_ctx ctx = {
 		.box = &box,
-		.radius = rc.corner_radius,
+		.radius = theme->corner_radius,
 		.line_width = theme->border_width,
 		.fill_color = theme->window_active_title_bg_color,
 		.border_color = theme->window_active_border_color,
@@ -1487,9 +1655,8 @@ post_processing(struct theme *theme)
 		+ 2 * theme->osd_window_switcher_item_padding_y
 		+ 2 * theme->osd_window_switcher_item_active_border_width;
 
-	if (rc.corner_radius >= theme->title_height) {
-		rc.corner_radius = theme->title_height - 1;
-	}
+	/* rc is left alone so that a taller titlebar restores the radius */
+	theme->corner_radius = MIN(rc.corner_radius, theme->title_height - 1);
 
 	int min_button_hover_radius =
 		MIN(theme->window_button_width, theme->window_button_height) / 2;
@@ -1569,6 +1736,62 @@ post_processing(struct theme *theme)
 	}
 }
 
+/*
+ * Only configured values go in here. Anything derived from the theme,
+ * like theme->corner_radius, would make every comparison against a
+ * freshly parsed rc.xml report a change.
+ */
+static void
+get_snapshot(struct buf *snapshot, const char *theme_name)
+{
+	buf_add_fmt(snapshot, "%s %d %d %d %d %d\n",
+		theme_name ? theme_name : "", rc.merge_config,
+		rc.corner_radius, rc.show_title, rc.ssd_keep_border,
+		rc.shadows_enabled);
+
+	struct font *fonts[] = {
+		&rc.font_activewindow,
+		&rc.font_inactivewindow,
+		&rc.font_menuheader,
+		&rc.font_menuitem,
+		&rc.font_osd,
+	};
+	for (size_t i = 0; i < ARRAY_SIZE(fonts); i++) {
+		buf_add_fmt(snapshot, "%s %d %d %d\n",
+			fonts[i]->name ? fonts[i]->name : "", fonts[i]->size,
+			fonts[i]->slant, fonts[i]->weight);
+	}
+
+	struct title_button *b;
+	wl_list_for_each(b, &rc.title_buttons_left, link) {
+		buf_add_fmt(snapshot, "%d ", b->type);
+	}
+	buf_add(snapshot, ":");
+	wl_list_for_each(b, &rc.title_buttons_right, link) {
+		buf_add_fmt(snapshot, " %d", b->type);
+	}
+	buf_add(snapshot, "\n");
+
+	struct wl_list paths;
+	paths_theme_create(&paths, theme_name, "");
+	paths_stat_snapshot(&paths, snapshot);
+	paths_destroy(&paths);
+
+	paths_config_create(&paths, "themerc-override");
+	paths_stat_snapshot(&paths, snapshot);
+	paths_destroy(&paths);
+}
+
+bool
+theme_needs_reload(struct theme *theme, const char *theme_name)
+{
+	struct buf snapshot = BUF_INIT;
+	get_snapshot(&snapshot, theme_name);
+	bool changed = strcmp(snapshot.data, theme->snapshot.data);
+	buf_reset(&snapshot);
+	return changed;
+}
+
 void
 theme_init(struct theme *theme, struct server *server, const char *theme_name)
 {
@@ -1577,6 +1800,7 @@ theme_init(struct theme *theme, struct server *server, const char *theme_name)
 	 * reconfigure as not all themes set all options
 	 */
 	theme_builtin(theme, server);
+	wl_list_init(&theme->scaled_buttons);
 
 	/* Read <data-dir>/share/themes/$theme_name/openbox-3/themerc */
 	struct wl_list paths;
@@ -1593,6 +1817,9 @@ theme_init(struct theme *theme, struct server *server, const char *theme_name)
 	create_corners(theme);
 	load_buttons(theme);
 	create_shadows(theme);
+
+	theme->snapshot = BUF_INIT;
+	get_snapshot(&theme->snapshot, theme_name);
 }
 
 void
@@ -1606,9 +1833,20 @@ theme_finish(struct theme *theme)
 				.buttons[type][state_set]);
 			zdrop(&theme->window[THEME_ACTIVE]
 				.buttons[type][state_set]);
+			zfree(theme->window[THEME_INACTIVE]
+				.button_sources[type][state_set].svg_filename);
+			zfree(theme->window[THEME_ACTIVE]
+				.button_sources[type][state_set].svg_filename);
 		}
 	}
 
+	struct scaled_button *scaled, *tmp;
+	wl_list_for_each_safe(scaled, tmp, &theme->scaled_buttons, link) {
+		zdrop(&scaled->buffer);
+		wl_list_remove(&scaled->link);
+		free(scaled);
+	}
+
 	zdrop(&theme->corner_top_left_active_normal);
 	zdrop(&theme->corner_top_left_inactive_normal);
 	zdrop(&theme->corner_top_right_active_normal);
@@ -1620,4 +1858,6 @@ theme_finish(struct theme *theme)
 	zdrop(&theme->shadow_corner_top_inactive);
 	zdrop(&theme->shadow_corner_bottom_inactive);
 	zdrop(&theme->shadow_edge_inactive);
+
+	buf_reset(&theme->snapshot);
 }
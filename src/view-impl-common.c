@@ -11,16 +11,14 @@
 void
 view_impl_move_to_front(struct view *view)
 {
-	wl_list_remove(&view->link);
-	wl_list_insert(&view->server->views, &view->link);
+	view_stack_move(view, /* to_front */ true);
 	wlr_scene_node_raise_to_top(&view->scene_tree->node);
 }
 
 void
 view_impl_move_to_back(struct view *view)
 {
-	wl_list_remove(&view->link);
-	wl_list_append(&view->server->views, &view->link);
+	view_stack_move(view, /* to_front */ false);
 	wlr_scene_node_lower_to_bottom(&view->scene_tree->node);
 }
 
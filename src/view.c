@@ -4,6 +4,7 @@
 #include <strings.h>
 #include <wlr/types/wlr_output_layout.h>
 #include <wlr/types/wlr_security_context_v1.h>
+#include "common/array.h"
 #include "common/box.h"
 #include "common/macros.h"
 #include "common/match.h"
@@ -55,7 +56,7 @@ view_from_wlr_surface(struct wlr_surface *surface)
 	return NULL;
 }
 
-static const struct wlr_security_context_v1_state *
+const struct wlr_security_context_v1_state *
 security_context_from_view(struct view *view)
 {
 	if (view && view->surface && view->surface->resource) {
@@ -66,6 +67,28 @@ security_context_from_view(struct view *view)
 	return NULL;
 }
 
+/*
+ * The predicates of a view_query, in the order they are evaluated:
+ * plain view state first, then checks which need a lookup or a virtual
+ * call, and string globs last.
+ */
+enum view_query_op {
+	VIEW_QUERY_SHADED = 0,
+	VIEW_QUERY_ICONIFIED,
+	VIEW_QUERY_OMNIPRESENT,
+	VIEW_QUERY_MAXIMIZED,
+	VIEW_QUERY_TILED,
+	VIEW_QUERY_FOCUSED,
+	VIEW_QUERY_WINDOW_TYPE,
+	VIEW_QUERY_DECORATION,
+	VIEW_QUERY_DESKTOP,
+	VIEW_QUERY_MONITOR,
+	VIEW_QUERY_TILED_REGION,
+	VIEW_QUERY_IDENTIFIER,
+	VIEW_QUERY_TITLE,
+	VIEW_QUERY_SANDBOX,
+};
+
 struct view_query *
 view_query_create(void)
 {
@@ -79,6 +102,7 @@ void
 view_query_free(struct view_query *query)
 {
 	wl_list_remove(&query->link);
+	wl_array_release(&query->ops);
 	zfree(query->identifier);
 	zfree(query->title);
 	zfree(query->sandbox_engine);
@@ -89,6 +113,43 @@ view_query_free(struct view_query *query)
 	zfree(query);
 }
 
+static void
+view_query_compile(struct view_query *query)
+{
+	bool used[VIEW_QUERY_SANDBOX + 1] = {
+		[VIEW_QUERY_SHADED] = query->shaded != LAB_STATE_UNSPECIFIED,
+		[VIEW_QUERY_ICONIFIED] = query->iconified != LAB_STATE_UNSPECIFIED,
+		[VIEW_QUERY_OMNIPRESENT] =
+			query->omnipresent != LAB_STATE_UNSPECIFIED,
+		[VIEW_QUERY_MAXIMIZED] = query->maximized != VIEW_AXIS_INVALID,
+		[VIEW_QUERY_TILED] = query->tiled != VIEW_EDGE_INVALID,
+		[VIEW_QUERY_FOCUSED] = query->focused != LAB_STATE_UNSPECIFIED,
+		[VIEW_QUERY_WINDOW_TYPE] = query->window_type >= 0,
+		[VIEW_QUERY_DECORATION] =
+			query->decoration != LAB_SSD_MODE_INVALID,
+		[VIEW_QUERY_DESKTOP] = query->desktop,
+		[VIEW_QUERY_MONITOR] = query->monitor,
+		[VIEW_QUERY_TILED_REGION] = query->tiled_region,
+		[VIEW_QUERY_IDENTIFIER] = query->identifier,
+		[VIEW_QUERY_TITLE] = query->title,
+		[VIEW_QUERY_SANDBOX] =
+			query->sandbox_engine || query->sandbox_app_id,
+	};
+
+	for (size_t op = 0; op < ARRAY_SIZE(used); op++) {
+		if (used[op]) {
+			array_add(&query->ops, (enum view_query_op)op);
+		}
+	}
+
+	glob_matcher_init(&query->identifier_matcher, query->identifier);
+	glob_matcher_init(&query->title_matcher, query->title);
+	glob_matcher_init(&query->sandbox_engine_matcher, query->sandbox_engine);
+	glob_matcher_init(&query->sandbox_app_id_matcher, query->sandbox_app_id);
+	glob_matcher_init(&query->tiled_region_matcher, query->tiled_region);
+	query->compiled = true;
+}
+
 static bool
 query_tristate_match(enum three_state desired, bool actual)
 {
@@ -103,107 +164,92 @@ query_tristate_match(enum three_state desired, bool actual)
 }
 
 static bool
-query_str_match(const char *condition, const char *value)
+query_desktop_match(struct view *view, const char *desktop)
 {
-	if (!condition) {
-		return true;
-	}
-	return value && match_glob(condition, value);
-}
-
-bool
-view_matches_query(struct view *view, struct view_query *query)
-{
-	if (!query_str_match(query->identifier, view_get_string_prop(view, "app_id"))) {
-		return false;
-	}
-
-	if (!query_str_match(query->title, view_get_string_prop(view, "title"))) {
-		return false;
-	}
-
-	if (query->window_type >= 0 && !view_contains_window_type(view, query->window_type)) {
-		return false;
-	}
-
-	if (query->sandbox_engine || query->sandbox_app_id) {
-		const struct wlr_security_context_v1_state *ctx =
-			security_context_from_view(view);
-
-		if (!ctx) {
-			return false;
-		}
-
-		if (!query_str_match(query->sandbox_engine, ctx->sandbox_engine)) {
-			return false;
-		}
+	const char *view_workspace = view->workspace->name;
+	struct workspace *current = view->server->workspaces.current;
 
-		if (!query_str_match(query->sandbox_app_id, ctx->app_id)) {
-			return false;
-		}
-	}
-
-	if (!query_tristate_match(query->shaded, view->shaded)) {
-		return false;
-	}
-
-	if (query->maximized != VIEW_AXIS_INVALID && view->maximized != query->maximized) {
-		return false;
-	}
-
-	if (!query_tristate_match(query->iconified, view->minimized)) {
-		return false;
-	}
-
-	if (!query_tristate_match(query->focused, view->server->active_view == view)) {
-		return false;
-	}
-
-	if (!query_tristate_match(query->omnipresent, view->visible_on_all_workspaces)) {
-		return false;
+	if (!strcasecmp(desktop, "other")) {
+		/* "other" means the view is NOT on the current desktop */
+		return strcasecmp(view_workspace, current->name);
 	}
 
-	if (query->tiled != VIEW_EDGE_INVALID && query->tiled != view->tiled) {
-		return false;
-	}
+	// TODO: perhaps wrap "left" and "right" workspaces
+	struct workspace *target =
+		workspaces_find(current, desktop, /* wrap */ false);
+	return target && !strcasecmp(view_workspace, target->name);
+}
 
-	const char *tiled_region =
-		view->tiled_region ? view->tiled_region->name : NULL;
-	if (!query_str_match(query->tiled_region, tiled_region)) {
-		return false;
-	}
+static bool
+query_sandbox_match(struct view *view, struct view_query *query)
+{
+	const struct wlr_security_context_v1_state *ctx =
+		security_context_from_view(view);
 
-	if (query->desktop) {
-		const char *view_workspace = view->workspace->name;
-		struct workspace *current = view->server->workspaces.current;
+	return ctx
+		&& glob_matcher_match(&query->sandbox_engine_matcher,
+			ctx->sandbox_engine)
+		&& glob_matcher_match(&query->sandbox_app_id_matcher,
+			ctx->app_id);
+}
 
-		if (!strcasecmp(query->desktop, "other")) {
-			/* "other" means the view is NOT on the current desktop */
-			if (!strcasecmp(view_workspace, current->name)) {
-				return false;
-			}
-		} else {
-			// TODO: perhaps wrap "left" and "right" workspaces
-			struct workspace *target =
-				workspaces_find(current, query->desktop, /* wrap */ false);
-			if (!target || strcasecmp(view_workspace, target->name)) {
-				return false;
-			}
-		}
+static bool
+query_op_match(struct view *view, struct view_query *query,
+		enum view_query_op op)
+{
+	switch (op) {
+	case VIEW_QUERY_SHADED:
+		return query_tristate_match(query->shaded, view->shaded);
+	case VIEW_QUERY_ICONIFIED:
+		return query_tristate_match(query->iconified, view->minimized);
+	case VIEW_QUERY_OMNIPRESENT:
+		return query_tristate_match(query->omnipresent,
+			view->visible_on_all_workspaces);
+	case VIEW_QUERY_MAXIMIZED:
+		return view->maximized == query->maximized;
+	case VIEW_QUERY_TILED:
+		return view->tiled == query->tiled;
+	case VIEW_QUERY_FOCUSED:
+		return query_tristate_match(query->focused,
+			view->server->active_view == view);
+	case VIEW_QUERY_WINDOW_TYPE:
+		return view_contains_window_type(view, query->window_type);
+	case VIEW_QUERY_DECORATION:
+		return view_get_ssd_mode(view) == query->decoration;
+	case VIEW_QUERY_DESKTOP:
+		return query_desktop_match(view, query->desktop);
+	case VIEW_QUERY_MONITOR:
+		return output_from_name(view->server, query->monitor)
+			== view->output;
+	case VIEW_QUERY_TILED_REGION:
+		return glob_matcher_match(&query->tiled_region_matcher,
+			view->tiled_region ? view->tiled_region->name : NULL);
+	case VIEW_QUERY_IDENTIFIER:
+		return glob_matcher_match(&query->identifier_matcher,
+			view_get_string_prop(view, "app_id"));
+	case VIEW_QUERY_TITLE:
+		return glob_matcher_match(&query->title_matcher,
+			view_get_string_prop(view, "title"));
+	case VIEW_QUERY_SANDBOX:
+		return query_sandbox_match(view, query);
 	}
+	return true;
+}
 
-	enum ssd_mode decor = view_get_ssd_mode(view);
-	if (query->decoration != LAB_SSD_MODE_INVALID && query->decoration != decor) {
-		return false;
+bool
+view_matches_query(struct view *view, struct view_query *query)
+{
+	if (!query->compiled) {
+		/* Queries are not modified once the config has been parsed */
+		view_query_compile(query);
 	}
 
-	if (query->monitor) {
-		struct output *target = output_from_name(view->server, query->monitor);
-		if (target != view->output) {
+	enum view_query_op *op;
+	wl_array_for_each(op, &query->ops) {
+		if (!query_op_match(view, query, *op)) {
 			return false;
 		}
 	}
-
 	return true;
 }
 
@@ -252,11 +298,76 @@ matches_criteria(struct view *view, enum lab_view_criteria criteria)
 	return true;
 }
 
+/*
+ * Return the first view in one of the per-workspace lists that is stacked
+ * below @from, or the first view of the list if @from is NULL
+ */
+static struct view *
+next_in_workspace_list(struct wl_list *list, struct view *from)
+{
+	struct wl_list *elm;
+	if (from && from->workspace_list == list) {
+		elm = from->workspace_link.next;
+	} else {
+		/*
+		 * Either the iterator lives in the other list or it has been
+		 * moved to another workspace while iterating, so search by
+		 * stacking serial instead.
+		 */
+		for (elm = list->next; elm != list; elm = elm->next) {
+			struct view *view = wl_container_of(elm, view,
+				workspace_link);
+			if (!from || view->stack_serial < from->stack_serial) {
+				break;
+			}
+		}
+	}
+	if (elm == list) {
+		return NULL;
+	}
+	struct view *view = wl_container_of(elm, view, workspace_link);
+	return view;
+}
+
+/*
+ * Merge the current workspace and always-on-top lists by stacking serial
+ * so that views are visited in the same order as in server->views.
+ */
+static struct view *
+next_on_current_workspace(struct server *server, struct view *view,
+		enum lab_view_criteria criteria)
+{
+	struct wl_list *workspace = &server->workspaces.current->views;
+	struct wl_list *always_on_top = &server->views_always_on_top;
+
+	for (;;) {
+		struct view *next = next_in_workspace_list(workspace, view);
+		struct view *next_on_top =
+			next_in_workspace_list(always_on_top, view);
+		if (!next || (next_on_top
+				&& next_on_top->stack_serial > next->stack_serial)) {
+			next = next_on_top;
+		}
+		if (!next) {
+			return NULL;
+		}
+		if (matches_criteria(next, criteria)) {
+			return next;
+		}
+		view = next;
+	}
+}
+
 struct view *
 view_next(struct wl_list *head, struct view *view, enum lab_view_criteria criteria)
 {
 	assert(head);
 
+	if (criteria & LAB_VIEW_CRITERIA_CURRENT_WORKSPACE) {
+		struct server *server = wl_container_of(head, server, views);
+		return next_on_current_workspace(server, view, criteria);
+	}
+
 	struct wl_list *elm = view ? &view->link : head;
 
 	for (elm = elm->next; elm != head; elm = elm->next) {
@@ -1520,6 +1631,80 @@ view_toggle_decorations(struct view *view)
 	}
 }
 
+/* Returns the per-workspace list that matches the view's scene parent */
+static struct wl_list *
+workspace_list_for(struct view *view)
+{
+	struct wlr_scene_tree *parent = view->scene_tree->node.parent;
+	if (parent == view->server->view_tree_always_on_top) {
+		return &view->server->views_always_on_top;
+	}
+	if (parent == view->workspace->tree) {
+		return &view->workspace->views;
+	}
+	return NULL;
+}
+
+static void
+update_workspace_list(struct view *view)
+{
+	wl_list_remove(&view->workspace_link);
+	wl_list_init(&view->workspace_link);
+
+	view->workspace_list = workspace_list_for(view);
+	if (!view->workspace_list) {
+		return;
+	}
+
+	/* Keep the list sorted by decreasing stacking serial */
+	struct wl_list *pos = view->workspace_list;
+	struct view *other;
+	wl_list_for_each(other, view->workspace_list, workspace_link) {
+		if (other->stack_serial < view->stack_serial) {
+			break;
+		}
+		pos = &other->workspace_link;
+	}
+	wl_list_insert(pos, &view->workspace_link);
+}
+
+void
+view_stack_add(struct view *view)
+{
+	assert(view->scene_tree);
+	struct server *server = view->server;
+	wl_list_insert(&server->views, &view->link);
+	view->stack_serial = ++server->view_stack_serials.front;
+	wl_list_init(&view->workspace_link);
+	update_workspace_list(view);
+}
+
+void
+view_stack_move(struct view *view, bool to_front)
+{
+	struct server *server = view->server;
+	wl_list_remove(&view->link);
+	if (to_front) {
+		wl_list_insert(&server->views, &view->link);
+		view->stack_serial = ++server->view_stack_serials.front;
+	} else {
+		wl_list_append(&server->views, &view->link);
+		view->stack_serial = --server->view_stack_serials.back;
+	}
+
+	/* The serial is now the highest/lowest so no need to search */
+	if (view->workspace_list) {
+		wl_list_remove(&view->workspace_link);
+		if (to_front) {
+			wl_list_insert(view->workspace_list,
+				&view->workspace_link);
+		} else {
+			wl_list_append(view->workspace_list,
+				&view->workspace_link);
+		}
+	}
+}
+
 bool
 view_is_always_on_top(struct view *view)
 {
@@ -1540,6 +1725,7 @@ view_toggle_always_on_top(struct view *view)
 		wlr_scene_node_reparent(&view->scene_tree->node,
 			view->server->view_tree_always_on_top);
 	}
+	update_workspace_list(view);
 }
 
 bool
@@ -1562,6 +1748,7 @@ view_toggle_always_on_bottom(struct view *view)
 		wlr_scene_node_reparent(&view->scene_tree->node,
 			view->server->view_tree_always_on_bottom);
 	}
+	update_workspace_list(view);
 }
 
 void
@@ -1581,6 +1768,7 @@ view_move_to_workspace(struct view *view, struct workspace *workspace)
 		view->workspace = workspace;
 		wlr_scene_node_reparent(&view->scene_tree->node,
 			workspace->tree);
+		update_workspace_list(view);
 	}
 }
 
@@ -2326,6 +2514,7 @@ void
 view_update_title(struct view *view)
 {
 	assert(view);
+	window_rules_invalidate(view);
 	const char *title = view_get_string_prop(view, "title");
 	if (!view->toplevel.handle || !title) {
 		return;
@@ -2338,6 +2527,7 @@ void
 view_update_app_id(struct view *view)
 {
 	assert(view);
+	window_rules_invalidate(view);
 	const char *app_id = view_get_string_prop(view, "app_id");
 	if (!view->toplevel.handle || !app_id) {
 		return;
@@ -2355,6 +2545,10 @@ view_reload_ssd(struct view *view)
 {
 	assert(view);
 	if (view->ssd_enabled && !view->fullscreen) {
+		/* Avoid rebuilding the whole scene tree where possible */
+		if (ssd_apply_theme(view->ssd)) {
+			return;
+		}
 		undecorate(view);
 		decorate(view);
 	}
@@ -2484,6 +2678,7 @@ view_destroy(struct view *view)
 	wl_list_remove(&view->request_fullscreen.link);
 	wl_list_remove(&view->set_title.link);
 	wl_list_remove(&view->destroy.link);
+	wl_array_release(&view->window_rules.matches);
 
 	if (view->toplevel.handle) {
 		wlr_foreign_toplevel_handle_v1_destroy(view->toplevel.handle);
@@ -2549,8 +2744,9 @@ view_destroy(struct view *view)
 		view->scene_tree = NULL;
 	}
 
-	/* Remove view from server->views */
+	/* Remove view from server->views and the per-workspace index */
 	wl_list_remove(&view->link);
+	wl_list_remove(&view->workspace_link);
 	free(view);
 
 	cursor_update_focus(server);
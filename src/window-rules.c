@@ -2,25 +2,192 @@
 #define _POSIX_C_SOURCE 200809L
 #include <assert.h>
 #include <stdbool.h>
-#include <cairo.h>
-#include <glib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
 #include <strings.h>
+#include <wlr/types/wlr_security_context_v1.h>
 #include <wlr/util/log.h>
 #include "action.h"
+#include "common/array.h"
+#include "common/macros.h"
 #include "common/match.h"
 #include "config/rcxml.h"
 #include "labwc.h"
 #include "view.h"
 #include "window-rules.h"
 
+static const struct {
+	const char *name;
+	size_t offset;
+} properties[] = {
+	{ "serverDecoration", offsetof(struct window_rule, server_decoration) },
+	{ "skipTaskbar", offsetof(struct window_rule, skip_taskbar) },
+	{ "skipWindowSwitcher", offsetof(struct window_rule, skip_window_switcher) },
+	{ "ignoreFocusRequest", offsetof(struct window_rule, ignore_focus_request) },
+	{ "ignoreConfigureRequest",
+		offsetof(struct window_rule, ignore_configure_request) },
+	{ "fixedPosition", offsetof(struct window_rule, fixed_position) },
+};
+
+/*
+ * Rules pre-partitioned by what they are used for so that lookups only
+ * have to consider the rules that can possibly make a difference.
+ */
+static struct {
+	/* Bumped on every window_rules_init() to invalidate view caches */
+	unsigned int generation;
+	int nr_rules;
+	/* struct window_rule *, in config order */
+	struct wl_array with_actions;
+	/* struct window_rule *, highest priority (last in config) first */
+	struct wl_array by_property[ARRAY_SIZE(properties)];
+} compiled;
+
+static enum property
+rule_property(struct window_rule *rule, size_t prop)
+{
+	return *(enum property *)((char *)rule + properties[prop].offset);
+}
+
+void
+window_rules_init(void)
+{
+	window_rules_finish();
+
+	/* 0 is reserved for views that have never been matched */
+	if (++compiled.generation == 0) {
+		compiled.generation = 1;
+	}
+
+	struct window_rule *rule;
+	wl_list_for_each(rule, &rc.window_rules, link) {
+		rule->index = compiled.nr_rules++;
+		glob_matcher_init(&rule->identifier_matcher, rule->identifier);
+		glob_matcher_init(&rule->title_matcher, rule->title);
+		glob_matcher_init(&rule->sandbox_engine_matcher,
+			rule->sandbox_engine);
+		glob_matcher_init(&rule->sandbox_app_id_matcher,
+			rule->sandbox_app_id);
+		if (!wl_list_empty(&rule->actions)) {
+			array_add(&compiled.with_actions, rule);
+		}
+	}
+
+	/*
+	 * Later items in the list have higher priority. For example, in the
+	 * config below we want the return value for foot's "serverDecoration"
+	 * property to be "default".
+	 *
+	 *     <windowRules>
+	 *       <windowRule identifier="*" serverDecoration="no"/>
+	 *       <windowRule identifier="foot" serverDecoration="default"/>
+	 *     </windowRules>
+	 *
+	 * Rules which do not set a particular property attribute are left
+	 * out so that they are never returned when that property is asked for.
+	 */
+	wl_list_for_each_reverse(rule, &rc.window_rules, link) {
+		for (size_t i = 0; i < ARRAY_SIZE(properties); i++) {
+			if (rule_property(rule, i)) {
+				array_add(&compiled.by_property[i], rule);
+			}
+		}
+	}
+}
+
+void
+window_rules_finish(void)
+{
+	compiled.nr_rules = 0;
+	wl_array_release(&compiled.with_actions);
+	wl_array_init(&compiled.with_actions);
+	for (size_t i = 0; i < ARRAY_SIZE(properties); i++) {
+		wl_array_release(&compiled.by_property[i]);
+		wl_array_init(&compiled.by_property[i]);
+	}
+}
+
+void
+window_rules_invalidate(struct view *view)
+{
+	view->window_rules.generation = 0;
+}
+
+/* Match the criteria which only change with the app_id or title */
+static bool
+rule_matches_strings(struct window_rule *rule, struct view *view)
+{
+	if (!glob_matcher_match(&rule->identifier_matcher,
+			view_get_string_prop(view, "app_id"))) {
+		return false;
+	}
+	if (!glob_matcher_match(&rule->title_matcher,
+			view_get_string_prop(view, "title"))) {
+		return false;
+	}
+	if (rule->sandbox_engine || rule->sandbox_app_id) {
+		const struct wlr_security_context_v1_state *ctx =
+			security_context_from_view(view);
+		if (!ctx) {
+			return false;
+		}
+		if (!glob_matcher_match(&rule->sandbox_engine_matcher,
+				ctx->sandbox_engine)) {
+			return false;
+		}
+		if (!glob_matcher_match(&rule->sandbox_app_id_matcher,
+				ctx->app_id)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static void
+update_cache(struct view *view)
+{
+	struct wl_array *matches = &view->window_rules.matches;
+	size_t size = (compiled.nr_rules + 31) / 32 * sizeof(uint32_t);
+	while (matches->size < size) {
+		array_add(matches, (uint32_t)0);
+	}
+	memset(matches->data, 0, matches->size);
+
+	uint32_t *bits = matches->data;
+	struct window_rule *rule;
+	wl_list_for_each(rule, &rc.window_rules, link) {
+		if (rule_matches_strings(rule, view)) {
+			bits[rule->index / 32] |= 1u << (rule->index % 32);
+		}
+	}
+	view->window_rules.generation = compiled.generation;
+}
+
 static bool
-other_instances_exist(struct view *self, struct view_query *query)
+view_matches_rule(struct view *view, struct window_rule *rule)
+{
+	if (view->window_rules.generation != compiled.generation) {
+		update_cache(view);
+	}
+	uint32_t *bits = view->window_rules.matches.data;
+	if (!(bits[rule->index / 32] & (1u << (rule->index % 32)))) {
+		return false;
+	}
+
+	/* Window types may change at any time, so are not cached */
+	return rule->window_type < 0
+		|| view_contains_window_type(view, rule->window_type);
+}
+
+static bool
+other_instances_exist(struct view *self, struct window_rule *rule)
 {
 	struct wl_list *views = &self->server->views;
 	struct view *view;
 
 	wl_list_for_each(view, views, link) {
-		if (view != self && view_matches_query(view, query)) {
+		if (view != self && view_matches_rule(view, rule)) {
 			return true;
 		}
 	}
@@ -30,32 +197,22 @@ other_instances_exist(struct view *self, struct view_query *query)
 static bool
 view_matches_criteria(struct window_rule *rule, struct view *view)
 {
-	struct view_query query = {
-		.identifier = rule->identifier,
-		.title = rule->title,
-		.window_type = rule->window_type,
-		.sandbox_engine = rule->sandbox_engine,
-		.sandbox_app_id = rule->sandbox_app_id,
-		.maximized = VIEW_AXIS_INVALID,
-	};
-
-	if (rule->match_once && other_instances_exist(view, &query)) {
+	if (!view_matches_rule(view, rule)) {
 		return false;
 	}
-
-	return view_matches_query(view, &query);
+	return !rule->match_once || !other_instances_exist(view, rule);
 }
 
 void
 window_rules_apply(struct view *view, enum window_rule_event event)
 {
-	struct window_rule *rule;
-	wl_list_for_each(rule, &rc.window_rules, link) {
-		if (rule->event != event) {
+	struct window_rule **rule;
+	wl_array_for_each(rule, &compiled.with_actions) {
+		if ((*rule)->event != event) {
 			continue;
 		}
-		if (view_matches_criteria(rule, view)) {
-			actions_run(view, view->server, &rule->actions, NULL);
+		if (view_matches_criteria(*rule, view)) {
+			actions_run(view, view->server, &(*rule)->actions, NULL);
 		}
 	}
 }
@@ -65,50 +222,17 @@ window_rules_get_property(struct view *view, const char *property)
 {
 	assert(property);
 
-	/*
-	 * We iterate in reverse here because later items in list have higher
-	 * priority. For example, in the config below we want the return value
-	 * for foot's "serverDecoration" property to be "default".
-	 *
-	 *     <windowRules>
-	 *       <windowRule identifier="*" serverDecoration="no"/>
-	 *       <windowRule identifier="foot" serverDecoration="default"/>
-	 *     </windowRules>
-	 */
-	struct window_rule *rule;
-	wl_list_for_each_reverse(rule, &rc.window_rules, link) {
-		/*
-		 * Only return if property != LAB_PROP_UNSPECIFIED otherwise a
-		 * <windowRule> which does not set a particular property
-		 * attribute would still return here if that property was asked
-		 * for.
-		 */
-		if (view_matches_criteria(rule, view)) {
-			if (rule->server_decoration
-					&& !strcasecmp(property, "serverDecoration")) {
-				return rule->server_decoration;
-			}
-			if (rule->skip_taskbar
-					&& !strcasecmp(property, "skipTaskbar")) {
-				return rule->skip_taskbar;
-			}
-			if (rule->skip_window_switcher
-					&& !strcasecmp(property, "skipWindowSwitcher")) {
-				return rule->skip_window_switcher;
-			}
-			if (rule->ignore_focus_request
-					&& !strcasecmp(property, "ignoreFocusRequest")) {
-				return rule->ignore_focus_request;
-			}
-			if (rule->ignore_configure_request
-					&& !strcasecmp(property, "ignoreConfigureRequest")) {
-				return rule->ignore_configure_request;
-			}
-			if (rule->fixed_position
-					&& !strcasecmp(property, "fixedPosition")) {
-				return rule->fixed_position;
+	for (size_t i = 0; i < ARRAY_SIZE(properties); i++) {
+		if (strcasecmp(property, properties[i].name)) {
+			continue;
+		}
+		struct window_rule **rule;
+		wl_array_for_each(rule, &compiled.by_property[i]) {
+			if (view_matches_criteria(*rule, view)) {
+				return rule_property(*rule, i);
 			}
 		}
+		break;
 	}
 	return LAB_PROP_UNSPECIFIED;
 }
@@ -192,6 +192,7 @@ add_workspace(struct server *server, const char *name)
 	workspace->server = server;
 	workspace->name = xstrdup(name);
 	workspace->tree = wlr_scene_tree_create(server->view_tree);
+	wl_list_init(&workspace->views);
 	wl_list_append(&server->workspaces.all, &workspace->link);
 	if (!server->workspaces.current) {
 		server->workspaces.current = workspace;
@@ -428,6 +429,13 @@ workspaces_find(struct workspace *anchor, const char *name, bool wrap)
 static void
 destroy_workspace(struct workspace *workspace)
 {
+	/* Normally empty, except when views outlive the workspaces on exit */
+	struct view *view, *tmp;
+	wl_list_for_each_safe(view, tmp, &workspace->views, workspace_link) {
+		wl_list_remove(&view->workspace_link);
+		wl_list_init(&view->workspace_link);
+		view->workspace_list = NULL;
+	}
 	wlr_scene_node_destroy(&workspace->tree->node);
 	zfree(workspace->name);
 	wl_list_remove(&workspace->link);
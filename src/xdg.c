@@ -204,6 +204,7 @@ handle_commit(struct wl_listener *listener, void *data)
 		wl_event_source_remove(view->pending_configure_timeout);
 		view->pending_configure_serial = 0;
 		view->pending_configure_timeout = NULL;
+		view->awaits_layout_change = false;
 		update_required = true;
 	}
 
@@ -264,6 +265,7 @@ handle_configure_timeout(void *data)
 	wl_event_source_remove(view->pending_configure_timeout);
 	view->pending_configure_serial = 0;
 	view->pending_configure_timeout = NULL;
+	view->awaits_layout_change = false;
 
 	bool empty_pending = wlr_box_empty(&view->pending);
 	if (empty_pending || view->pending.x != view->current.x
@@ -976,7 +978,7 @@ xdg_toplevel_new(struct wl_listener *listener, void *data)
 	CONNECT_SIGNAL(toplevel, xdg_toplevel_view, request_show_window_menu);
 	CONNECT_SIGNAL(xdg_surface, xdg_toplevel_view, new_popup);
 
-	wl_list_insert(&server->views, &view->link);
+	view_stack_add(view);
 }
 
 void
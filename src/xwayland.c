@@ -1,13 +1,18 @@
 // SPDX-License-Identifier: GPL-2.0-only
 #define _POSIX_C_SOURCE 200809L
 #include <assert.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
 #include <wlr/xwayland.h>
 #include "common/array.h"
 #include "common/macros.h"
 #include "common/mem.h"
 #include "config/rcxml.h"
 #include "config/session.h"
+#include "idle.h"
 #include "labwc.h"
 #include "node.h"
 #include "ssd.h"
@@ -215,6 +220,9 @@ handle_commit(struct wl_listener *listener, void *data)
 	struct wlr_surface_state *state = &view->surface->current;
 	struct wlr_box *current = &view->current;
 
+	/* See layout_change_hold_frames() */
+	view->awaits_layout_change = false;
+
 	/*
 	 * If there is a pending move/resize, wait until the surface
 	 * size changes to update geometry. The hope is to update both
@@ -271,6 +279,8 @@ handle_associate(struct wl_listener *listener, void *data)
 
 	view_connect_map(&xwayland_view->base,
 		xwayland_view->xwayland_surface->surface);
+	/* The security context is looked up via the surface */
+	window_rules_invalidate(&xwayland_view->base);
 }
 
 static void
@@ -311,6 +321,12 @@ handle_destroy(struct wl_listener *listener, void *data)
 	}
 	view->surface = NULL;
 
+	if (xwayland_view->configure_idle) {
+		wl_event_source_remove(xwayland_view->configure_idle);
+		xwayland_view->configure_idle = NULL;
+	}
+	wl_list_remove(&xwayland_view->stack_link);
+
 	/*
 	 * Break view <-> xsurface association.  Note that the xsurface
 	 * may not actually be destroyed at this point; it may become an
@@ -335,12 +351,51 @@ handle_destroy(struct wl_listener *listener, void *data)
 	view_destroy(view);
 }
 
+static void
+flush_configure(struct xwayland_view *xwayland_view)
+{
+	if (!xwayland_view->configure_idle) {
+		return;
+	}
+	wl_event_source_remove(xwayland_view->configure_idle);
+	xwayland_view->configure_idle = NULL;
+
+	struct wlr_box *geo = &xwayland_view->configure_geo;
+	wlr_xwayland_surface_configure(xwayland_view->xwayland_surface,
+		geo->x, geo->y, geo->width, geo->height);
+}
+
+static void
+handle_configure_idle(void *data)
+{
+	struct xwayland_view *xwayland_view = data;
+	struct wlr_box *geo = &xwayland_view->configure_geo;
+
+	/* The idle source is removed automatically after this call */
+	xwayland_view->configure_idle = NULL;
+	wlr_xwayland_surface_configure(xwayland_view->xwayland_surface,
+		geo->x, geo->y, geo->width, geo->height);
+}
+
 static void
 xwayland_view_configure(struct view *view, struct wlr_box geo)
 {
+	struct xwayland_view *xwayland_view = xwayland_view_from_view(view);
 	view->pending = geo;
-	wlr_xwayland_surface_configure(xwayland_surface_from_view(view),
-		geo.x, geo.y, geo.width, geo.height);
+
+	/*
+	 * Actions, window rules and layout changes often move/resize,
+	 * maximize and fullscreen the same view several times during one
+	 * event loop iteration. Send only the final geometry to the client
+	 * from an idle callback (similar to what wlroots does for xdg-shell
+	 * configure events) so that it doesn't redraw for each step.
+	 */
+	xwayland_view->configure_geo = geo;
+	if (!xwayland_view->configure_idle) {
+		xwayland_view->configure_idle = wl_event_loop_add_idle(
+			view->server->wl_event_loop, handle_configure_idle,
+			xwayland_view);
+	}
 
 	/*
 	 * For unknown reasons, XWayland surfaces that are completely
@@ -604,6 +659,10 @@ handle_map_request(struct wl_listener *listener, void *data)
 		axis |= VIEW_AXIS_VERTICAL;
 	}
 	view_maximize(view, axis, /*store_natural_geometry*/ true);
+
+	/* Make sure the window is mapped with its final geometry */
+	flush_configure(xwayland_view);
+
 	/*
 	 * We could also call set_initial_position() here, but it's not
 	 * really necessary until the view is actually mapped (and at
@@ -747,6 +806,7 @@ xwayland_view_map(struct view *view)
 		 */
 		view->current = view->pending;
 		view_moved(view);
+		flush_configure(xwayland_view);
 	}
 
 	/*
@@ -813,6 +873,29 @@ xwayland_view_minimize(struct view *view, bool minimized)
 		minimized);
 }
 
+/*
+ * Restack the X11 window above or below all of its siblings and mirror
+ * the request in server->xwayland_stack so that the stacking order the
+ * XWM already knows about does not have to be sent again.
+ */
+static void
+restack(struct view *view, enum xcb_stack_mode_t mode)
+{
+	struct xwayland_view *xwayland_view = xwayland_view_from_view(view);
+
+	wlr_xwayland_surface_restack(xwayland_view->xwayland_surface,
+		NULL, mode);
+
+	wl_list_remove(&xwayland_view->stack_link);
+	if (mode == XCB_STACK_MODE_ABOVE) {
+		wl_list_insert(&view->server->xwayland_stack,
+			&xwayland_view->stack_link);
+	} else {
+		wl_list_insert(view->server->xwayland_stack.prev,
+			&xwayland_view->stack_link);
+	}
+}
+
 static void
 xwayland_view_move_to_front(struct view *view)
 {
@@ -834,8 +917,7 @@ xwayland_view_move_to_front(struct view *view)
 	 * the unmanaged surfaces afterward is ugly and still doesn't
 	 * account for always-on-top views.
 	 */
-	wlr_xwayland_surface_restack(xwayland_surface_from_view(view),
-		NULL, XCB_STACK_MODE_ABOVE);
+	restack(view, XCB_STACK_MODE_ABOVE);
 }
 
 static void
@@ -843,8 +925,7 @@ xwayland_view_move_to_back(struct view *view)
 {
 	view_impl_move_to_back(view);
 	/* Update XWayland stacking order */
-	wlr_xwayland_surface_restack(xwayland_surface_from_view(view),
-		NULL, XCB_STACK_MODE_BELOW);
+	restack(view, XCB_STACK_MODE_BELOW);
 }
 
 static struct view *
@@ -933,8 +1014,7 @@ xwayland_view_shade(struct view *view, bool shaded)
 
 	/* Ensure that clicks on some xwayland surface don't end up on the shaded one */
 	if (shaded) {
-		wlr_xwayland_surface_restack(xwayland_surface_from_view(view),
-			NULL, XCB_STACK_MODE_BELOW);
+		restack(view, XCB_STACK_MODE_BELOW);
 	} else {
 		xwayland_adjust_stacking_order(view->server);
 	}
@@ -983,6 +1063,9 @@ xwayland_view_create(struct server *server,
 	xwayland_view->xwayland_surface = xsurface;
 	xsurface->data = view;
 
+	/* X11 stacks newly created windows above their siblings */
+	wl_list_insert(&server->xwayland_stack, &xwayland_view->stack_link);
+
 	view->workspace = server->workspaces.current;
 	view->scene_tree = wlr_scene_tree_create(view->workspace->tree);
 	node_descriptor_create(&view->scene_tree->node, LAB_NODE_DESC_VIEW, view);
@@ -1007,7 +1090,7 @@ xwayland_view_create(struct server *server,
 	CONNECT_SIGNAL(xsurface, xwayland_view, set_window_type);
 	CONNECT_SIGNAL(xsurface, xwayland_view, map_request);
 
-	wl_list_insert(&view->server->views, &view->link);
+	view_stack_add(view);
 
 	if (xsurface->surface) {
 		handle_associate(&xwayland_view->associate, NULL);
@@ -1068,6 +1151,82 @@ sync_atoms(xcb_connection_t *xcb_conn)
 	}
 }
 
+/* See <core><xwaylandPrewarmDelay> */
+static struct {
+	struct wl_event_source *timer;
+	bool triggered;
+	/* Connection that makes the lazy XWayland server start up */
+	int probe_fd;
+	/* Connection that keeps the XWayland server from terminating */
+	xcb_connection_t *keepalive;
+} prewarm = { .probe_fd = -1 };
+
+static void
+prewarm_connect_probe(struct wlr_xwayland_server *xserver)
+{
+	struct sockaddr_un addr = { .sun_family = AF_UNIX };
+	snprintf(addr.sun_path, sizeof(addr.sun_path), "/tmp/.X11-unix/X%d",
+		xserver->display);
+
+	int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (fd < 0) {
+		wlr_log_errno(WLR_ERROR, "cannot create socket to prewarm xwayland");
+		return;
+	}
+	if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		wlr_log_errno(WLR_ERROR, "cannot connect to %s", addr.sun_path);
+		close(fd);
+		return;
+	}
+	prewarm.probe_fd = fd;
+}
+
+static int
+handle_prewarm_timer(void *data)
+{
+	struct server *server = data;
+	struct wlr_xwayland_server *xserver = server->xwayland->server;
+
+	/* Wait until there has been no user input for the configured time */
+	int delay = rc.xwayland_prewarm_delay * 1000;
+	int idle = idle_manager_get_idle_msec();
+	if (idle < delay) {
+		wl_event_source_timer_update(prewarm.timer, delay - idle);
+		return 0;
+	}
+
+	wlr_log(WLR_DEBUG, "prewarming xwayland after %d ms idle", idle);
+	prewarm.triggered = true;
+	if (xserver->ready) {
+		/* Already started by some X11 client, just keep it alive */
+		prewarm.keepalive = xcb_connect(NULL, NULL);
+	} else if (!xserver->pid) {
+		/*
+		 * A pending connection on the X11 socket makes wlroots
+		 * start the lazy server. handle_server_ready() takes over.
+		 */
+		prewarm_connect_probe(xserver);
+	}
+	return 0;
+}
+
+static void
+prewarm_finish(void)
+{
+	if (prewarm.timer) {
+		wl_event_source_remove(prewarm.timer);
+		prewarm.timer = NULL;
+	}
+	if (prewarm.probe_fd >= 0) {
+		close(prewarm.probe_fd);
+		prewarm.probe_fd = -1;
+	}
+	if (prewarm.keepalive) {
+		xcb_disconnect(prewarm.keepalive);
+		prewarm.keepalive = NULL;
+	}
+}
+
 static void
 handle_server_ready(struct wl_listener *listener, void *data)
 {
@@ -1087,6 +1246,24 @@ handle_server_ready(struct wl_listener *listener, void *data)
 
 	wlr_log(WLR_DEBUG, "Connected to xwayland");
 	sync_atoms(xcb_conn);
+
+	if (prewarm.triggered) {
+		/*
+		 * Hold on to the connection so that the prewarmed server
+		 * is not terminated again for lack of clients. This also
+		 * covers the server being restarted after a crash.
+		 */
+		if (prewarm.probe_fd >= 0) {
+			close(prewarm.probe_fd);
+			prewarm.probe_fd = -1;
+		}
+		if (prewarm.keepalive) {
+			xcb_disconnect(prewarm.keepalive);
+		}
+		prewarm.keepalive = xcb_conn;
+		return;
+	}
+
 	wlr_log(WLR_DEBUG, "Disconnecting from xwayland");
 	xcb_disconnect(xcb_conn);
 }
@@ -1110,6 +1287,7 @@ xwayland_server_init(struct server *server, struct wlr_compositor *compositor)
 		wlr_log(WLR_ERROR, "cannot create xwayland server");
 		exit(EXIT_FAILURE);
 	}
+	wl_list_init(&server->xwayland_stack);
 	server->xwayland_new_surface.notify = handle_new_surface;
 	wl_signal_add(&server->xwayland->events.new_surface,
 		&server->xwayland_new_surface);
@@ -1122,6 +1300,13 @@ xwayland_server_init(struct server *server, struct wlr_compositor *compositor)
 	wl_signal_add(&server->xwayland->events.ready,
 		&server->xwayland_xwm_ready);
 
+	if (!rc.xwayland_persistence && rc.xwayland_prewarm_delay > 0) {
+		prewarm.timer = wl_event_loop_add_timer(server->wl_event_loop,
+			handle_prewarm_timer, server);
+		wl_event_source_timer_update(prewarm.timer,
+			rc.xwayland_prewarm_delay * 1000);
+	}
+
 	if (setenv("DISPLAY", server->xwayland->display_name, true) < 0) {
 		wlr_log_errno(WLR_ERROR, "unable to set DISPLAY for xwayland");
 	} else {
@@ -1159,11 +1344,48 @@ xwayland_server_init(struct server *server, struct wlr_compositor *compositor)
  * - start scrolling
  * - all scroll events should end up on the maximized window on the other workspace
  */
+/*
+ * Returns how many of the bottom-most entries of @wanted (top-most first)
+ * are already stacked in that order at the top of server->xwayland_stack
+ * once the remaining entries have been raised above them.
+ */
+static size_t
+count_in_place(struct server *server, struct view **wanted, size_t len)
+{
+	for (size_t keep = len; keep > 0; keep--) {
+		struct view **expected = wanted + len - keep;
+		size_t matched = 0;
+		struct xwayland_view *xwayland_view;
+		wl_list_for_each(xwayland_view, &server->xwayland_stack,
+				stack_link) {
+			struct view *view = &xwayland_view->base;
+			bool raised = false;
+			for (struct view **v = wanted; v < expected; v++) {
+				if (*v == view) {
+					raised = true;
+					break;
+				}
+			}
+			if (raised) {
+				continue;
+			}
+			if (view != expected[matched]) {
+				break;
+			}
+			if (++matched == keep) {
+				return keep;
+			}
+		}
+	}
+	return 0;
+}
+
 void
 xwayland_adjust_stacking_order(struct server *server)
 {
 	struct view **view;
 	struct wl_array views;
+	struct wl_array wanted;
 
 	wl_array_init(&views);
 	view_array_append(server, &views, LAB_VIEW_CRITERIA_ALWAYS_ON_TOP);
@@ -1171,14 +1393,33 @@ xwayland_adjust_stacking_order(struct server *server)
 		| LAB_VIEW_CRITERIA_NO_ALWAYS_ON_TOP);
 
 	/*
-	 * view_array_append() provides top-most windows
-	 * first so we simply reverse the iteration here
+	 * The scene graph already has the right order (always-on-top views
+	 * live in their own tree and workspaces are separate trees), so only
+	 * the X11 stacking order needs fixing up. Collect the XWayland views
+	 * that must end up on top, in the same top-most first order.
 	 */
-	wl_array_for_each_reverse(view, &views) {
-		view_move_to_front(*view);
+	wl_array_init(&wanted);
+	wl_array_for_each(view, &views) {
+		if ((*view)->type != LAB_XWAYLAND_VIEW || (*view)->shaded) {
+			continue;
+		}
+		struct view **entry = wl_array_add(&wanted, sizeof(*entry));
+		*entry = *view;
 	}
-
 	wl_array_release(&views);
+
+	/*
+	 * Skip the bottom part of the wanted order that the XWM already has
+	 * at the top of its stack and raise the rest, bottom-most first.
+	 */
+	size_t len = wanted.size / sizeof(struct view *);
+	struct view **entries = wanted.data;
+	size_t keep = count_in_place(server, entries, len);
+	for (size_t i = len - keep; i > 0; i--) {
+		restack(entries[i - 1], XCB_STACK_MODE_ABOVE);
+	}
+
+	wl_array_release(&wanted);
 }
 
 void
@@ -1235,6 +1476,7 @@ void
 xwayland_server_finish(struct server *server)
 {
 	struct wlr_xwayland *xwayland = server->xwayland;
+	prewarm_finish();
 	/*
 	 * Reset server->xwayland to NULL first to prevent callbacks (like
 	 * server_global_filter) from accessing it as it is destroyed
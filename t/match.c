@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: GPL-2.0-only
+#define _POSIX_C_SOURCE 200809L
+#include <locale.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <cmocka.h>
+#include "common/macros.h"
+#include "common/match.h"
+
+static bool
+compiled_match(const char *pattern, const char *string)
+{
+	struct glob_matcher matcher;
+	glob_matcher_init(&matcher, pattern);
+	return glob_matcher_match(&matcher, string);
+}
+
+static void
+test_glob_matcher_type(void **state)
+{
+	(void)state;
+
+	struct glob_matcher matcher;
+	glob_matcher_init(&matcher, NULL);
+	assert_int_equal(matcher.type, LAB_GLOB_NONE);
+	glob_matcher_init(&matcher, "*");
+	assert_int_equal(matcher.type, LAB_GLOB_ANY);
+	glob_matcher_init(&matcher, "foot");
+	assert_int_equal(matcher.type, LAB_GLOB_LITERAL);
+	glob_matcher_init(&matcher, "org.gnome.*");
+	assert_int_equal(matcher.type, LAB_GLOB_PREFIX);
+	glob_matcher_init(&matcher, "*firefox*");
+	assert_int_equal(matcher.type, LAB_GLOB_FNMATCH);
+	glob_matcher_init(&matcher, "foo?*");
+	assert_int_equal(matcher.type, LAB_GLOB_FNMATCH);
+
+	/* Non-ASCII patterns always go through fnmatch() */
+	glob_matcher_init(&matcher, "Übersicht");
+	assert_int_equal(matcher.type, LAB_GLOB_FNMATCH);
+	glob_matcher_init(&matcher, "Übersicht*");
+	assert_int_equal(matcher.type, LAB_GLOB_FNMATCH);
+}
+
+static void
+test_glob_matcher_match(void **state)
+{
+	(void)state;
+
+	static const char * const patterns[] = {
+		"*", "foot", "FOOT", "org.gnome.*", "*firefox*", "fo?t", "foo?*",
+		"[Ff]oot", "a\\*", "Übersicht", "übersicht*",
+	};
+	static const char * const strings[] = {
+		"", "foot", "Foot", "footclient", "org.gnome.Nautilus",
+		"ORG.GNOME.", "org.gnome", "Mozilla Firefox", "fo", "a*", "ab",
+		"Übersicht", "übersicht", "ÜBERSICHT - Dokument",
+	};
+
+	/* The compiled matcher must agree with match_glob() */
+	for (size_t i = 0; i < ARRAY_SIZE(patterns); i++) {
+		for (size_t j = 0; j < ARRAY_SIZE(strings); j++) {
+			assert_int_equal(compiled_match(patterns[i], strings[j]),
+				match_glob(patterns[i], strings[j]));
+		}
+	}
+
+	assert_true(compiled_match(NULL, NULL));
+	assert_true(compiled_match(NULL, "foot"));
+	assert_false(compiled_match("*", NULL));
+	assert_false(compiled_match("foot", NULL));
+}
+
+int main(int argc, char **argv)
+{
+	/* Let fnmatch() fold non-ASCII case like labwc does */
+	setlocale(LC_CTYPE, "C.UTF-8");
+
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_glob_matcher_type),
+		cmocka_unit_test(test_glob_matcher_match),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}